@@ -1,12 +1,18 @@
 #include <moreorg/algebra/Connectivity.hpp>
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
 #include <fstream>
 #include <unistd.h>
 #include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
 #include <graph_analysis/GraphIO.hpp>
 #include "metrics/Redundancy.hpp"
+#include "utils/GecodeUtils.hpp"
+#include "PropertyConstraintSolver.hpp"
 #include "ModelPoolIterator.hpp"
+#include "utils/OrganizationStructureGeneration.hpp"
 
 using namespace owlapi::model;
 using namespace moreorg;
@@ -82,10 +88,18 @@ Spec loadSpec(const std::string& filename)
     return spec;
 }
 
+/**
+ * Run the connectivity check for the given model pool
+ * \param resetQueryCache If true, reset the query cache and the witness
+ * library before each check, so that each check performs the search (which
+ * is required to compare seeds). Note that constructing the
+ * OrganizationModelAsk fills the witness library
+ */
 std::vector< algebra::Connectivity::Statistics> runModelPoolTest(const OrganizationModel::Ptr& om, const ModelPool& modelPool,
         size_t epochs,
         size_t minFeasible,
-        size_t timeoutInS)
+        size_t timeoutInS,
+        bool resetQueryCache = false)
 {
     OrganizationModelAsk ask(om, modelPool, true);
     std::vector<algebra::Connectivity::Statistics> stats;
@@ -94,6 +108,10 @@ std::vector< algebra::Connectivity::Statistics> runModelPoolTest(const Organizat
 
     for(size_t i = 0; i < epochs; ++i)
     {
+        if(resetQueryCache)
+        {
+            algebra::Connectivity::resetQueryCache();
+        }
         BaseGraph::Ptr baseGraph;
         bool feasible = algebra::Connectivity::isFeasible(modelPool, ask, baseGraph, timeoutInS*1000, minFeasible);
         if(baseGraph)
@@ -189,6 +207,357 @@ std::vector<numeric::Stats<double> > runFunctionalSaturationBoundTest(Organizati
     return stats;
 }
 
+/**
+ * Search configuration of the connectivity check that is evaluated when
+ * tuning
+ */
+struct SearchConfiguration
+{
+    std::string variableSelection;
+    std::string valueSelection;
+    std::string cutoff;
+    unsigned long cutoffScale;
+    unsigned long nogoodsLimit;
+
+    std::string toString() const
+    {
+        std::stringstream ss;
+        ss << variableSelection << " " << valueSelection << " "
+            << cutoff << "(" << cutoffScale << ") "
+            << nogoodsLimit;
+        return ss.str();
+    }
+
+    /**
+     * Get the configuration in the format of qxcfg::Configuration
+     * \param useWitnessLibrary Allow the connectivity check to answer queries
+     * from the witness library, i.e. without search
+     */
+    std::string toXML(bool useWitnessLibrary = true) const
+    {
+        std::stringstream ss;
+        ss << "<organization-model>" << std::endl;
+        ss << "    <connectivity>" << std::endl;
+        ss << "        <branching>" << std::endl;
+        ss << "            <variable-selection>" << variableSelection << "</variable-selection>" << std::endl;
+        ss << "            <value-selection>" << valueSelection << "</value-selection>" << std::endl;
+        ss << "        </branching>" << std::endl;
+        ss << "        <search>" << std::endl;
+        ss << "            <cutoff>" << cutoff << "</cutoff>" << std::endl;
+        ss << "            <cutoff-scale>" << cutoffScale << "</cutoff-scale>" << std::endl;
+        ss << "            <nogoods-limit>" << nogoodsLimit << "</nogoods-limit>" << std::endl;
+        ss << "        </search>" << std::endl;
+        ss << "        <witness-library>" << (useWitnessLibrary ? "true" : "false") << "</witness-library>" << std::endl;
+        ss << "    </connectivity>" << std::endl;
+        ss << "</organization-model>" << std::endl;
+        return ss.str();
+    }
+
+    void save(const std::string& filename, bool useWitnessLibrary = true) const
+    {
+        std::ofstream file(filename, std::ofstream::out);
+        file << toXML(useWitnessLibrary);
+        file.close();
+    }
+};
+
+struct TuningResult
+{
+    SearchConfiguration configuration;
+    /// False, if the configuration cannot be applied to the connectivity check
+    bool supported;
+    /// Number of checks that have been stopped due to the timeout
+    size_t stopped;
+    double timeInS;
+    double nodes;
+    double fails;
+    double restarts;
+
+    TuningResult()
+        : supported(true)
+        , stopped(0)
+        , timeInS(0)
+        , nodes(0)
+        , fails(0)
+        , restarts(0)
+    {}
+
+    /**
+     * Rank by number of stopped checks, time and number of nodes
+     */
+    bool operator<(const TuningResult& other) const
+    {
+        if(supported != other.supported)
+        {
+            return supported;
+        }
+        if(stopped != other.stopped)
+        {
+            return stopped < other.stopped;
+        }
+        if(timeInS != other.timeInS)
+        {
+            return timeInS < other.timeInS;
+        }
+        return nodes < other.nodes;
+    }
+};
+
+std::vector<SearchConfiguration> getSearchConfigurations()
+{
+    std::vector<SearchConfiguration> configurations;
+    std::vector<unsigned long> nogoodsLimits = { 0, 128, 1024 };
+    for(const std::pair<Gecode::IntVarBranch::Select, std::string>& var : utils::GecodeUtils::IntVarSelect2Txt)
+    {
+        if(var.first == Gecode::IntVarBranch::SEL_NONE)
+        {
+            continue;
+        }
+        for(const std::pair<Gecode::IntValBranch::Select, std::string>& val : utils::GecodeUtils::IntValSelect2Txt)
+        {
+            for(const std::string& cutoff : utils::GecodeUtils::CutoffTypes)
+            {
+                for(unsigned long nogoodsLimit : nogoodsLimits)
+                {
+                    SearchConfiguration configuration;
+                    configuration.variableSelection = var.second;
+                    configuration.valueSelection = val.second;
+                    configuration.cutoff = cutoff;
+                    configuration.cutoffScale = 10;
+                    configuration.nogoodsLimit = nogoodsLimit;
+                    configurations.push_back(configuration);
+                }
+            }
+        }
+    }
+    return configurations;
+}
+
+/**
+ * Run the connectivity check for all model pools of the spec with the given
+ * search configuration
+ */
+TuningResult runTuning(const OrganizationModel::Ptr& om, const Spec& spec,
+        const SearchConfiguration& configuration,
+        size_t epochs,
+        size_t minFeasible,
+        size_t timeoutInS)
+{
+    TuningResult result;
+    result.configuration = configuration;
+
+    // Each check has to perform the search
+    std::string filename = "/tmp/organization-model-benchmark-tuning.xml";
+    configuration.save(filename, false);
+    algebra::Connectivity::setConfiguration(qxcfg::Configuration(filename));
+
+    OrganizationModelAsk ask(om);
+    ModelPoolIterator mit(spec.from, spec.to, spec.stepSize);
+    while(mit.next())
+    {
+        ModelPool current = mit.current();
+        for(size_t i = 0; i < epochs; ++i)
+        {
+            algebra::Connectivity::resetQueryCache();
+            try {
+                algebra::Connectivity::isFeasible(current, ask, timeoutInS*1000, minFeasible);
+            } catch(const std::exception& e)
+            {
+                LOG_INFO_S << "moreorg::Benchmark: configuration " << configuration.toString()
+                    << " is not supported: " << e.what();
+                result.supported = false;
+                return result;
+            }
+
+            const algebra::Connectivity::Statistics& stats = algebra::Connectivity::getStatistics();
+            result.stopped += stats.stopped ? 1 : 0;
+            result.timeInS += stats.timeInS;
+            result.nodes += stats.csp.node;
+            result.fails += stats.csp.fail;
+            result.restarts += stats.csp.restart;
+        }
+    }
+    return result;
+}
+
+std::string toString(const std::vector<TuningResult>& results)
+{
+    std::stringstream ss;
+    ss << "# [rank] [variable-selection] [value-selection] [cutoff] [cutoff-scale] [nogoods-limit]"
+        << " [# stopped] [time in s] [# expanded nodes] [# failed nodes] [# restarts]" << std::endl;
+    size_t rank = 0;
+    for(const TuningResult& r : results)
+    {
+        if(!r.supported)
+        {
+            continue;
+        }
+        ss << std::setw(5) << ++rank << " "
+            << std::setw(20) << r.configuration.variableSelection << " "
+            << std::setw(12) << r.configuration.valueSelection << " "
+            << std::setw(10) << r.configuration.cutoff << " "
+            << std::setw(5) << r.configuration.cutoffScale << " "
+            << std::setw(6) << r.configuration.nogoodsLimit << " "
+            << std::setw(4) << r.stopped << " "
+            << std::setw(12) << r.timeInS << " "
+            << std::setw(12) << r.nodes << " "
+            << std::setw(12) << r.fails << " "
+            << std::setw(8) << r.restarts
+            << std::endl;
+    }
+    return ss.str();
+}
+
+/**
+ * Micro-benchmark of merging property constraints in closed form vs.
+ * using Gecode, on random sets of constraints of a few properties
+ * \param epochs Number of repetitions per number of constraints
+ */
+std::string runPropertyConstraintBenchmark(size_t epochs)
+{
+    std::vector<IRI> properties = { vocabulary::OM::mass(),
+        vocabulary::OM::resolve("loadAreaSize"),
+        vocabulary::OM::resolve("transportCapacity") };
+    std::vector<PropertyConstraint::ConstraintType> types = { PropertyConstraint::EQUAL,
+        PropertyConstraint::LESS_THAN, PropertyConstraint::LESS_EQUAL,
+        PropertyConstraint::GREATER_EQUAL, PropertyConstraint::GREATER_THAN };
+
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<size_t> propertyDistribution(0, properties.size() - 1);
+    std::uniform_int_distribution<size_t> typeDistribution(0, types.size() - 1);
+    std::uniform_real_distribution<double> valueDistribution(0.0, 100.0);
+
+    std::stringstream ss;
+    ss << "# property constraint merge: time per merge in microseconds" << std::endl;
+    ss << "# [number of constraints] [feasible] [interval time] [csp time] [speedup]" << std::endl;
+    for(size_t numberOfConstraints = 1; numberOfConstraints <= 16; numberOfConstraints *= 2)
+    {
+        std::vector<PropertyConstraint::Set> constraintSets;
+        for(size_t e = 0; e < std::max<size_t>(epochs, 1000); ++e)
+        {
+            PropertyConstraint::Set constraints;
+            for(size_t c = 0; c < numberOfConstraints; ++c)
+            {
+                constraints.insert(PropertyConstraint(properties[propertyDistribution(generator)],
+                            types[typeDistribution(generator)],
+                            valueDistribution(generator)));
+            }
+            constraintSets.push_back(constraints);
+        }
+
+        size_t feasible = 0;
+        base::Time start = base::Time::now();
+        for(const PropertyConstraint::Set& constraints : constraintSets)
+        {
+            try {
+                PropertyConstraintSolver::mergeIntervals(constraints);
+                ++feasible;
+            } catch(const std::invalid_argument& e)
+            {}
+        }
+        double intervalTime = (base::Time::now() - start).toSeconds();
+
+        start = base::Time::now();
+        for(const PropertyConstraint::Set& constraints : constraintSets)
+        {
+            try {
+                PropertyConstraintSolver::mergeCSP(constraints);
+            } catch(const std::invalid_argument& e)
+            {}
+        }
+        double cspTime = (base::Time::now() - start).toSeconds();
+
+        double scale = 1E06/constraintSets.size();
+        ss << std::setw(4) << numberOfConstraints << " "
+            << std::setw(6) << feasible << " "
+            << std::setw(12) << intervalTime*scale << " "
+            << std::setw(12) << cspTime*scale << " "
+            << std::setw(8) << (intervalTime > 0 ? cspTime/intervalTime : 0)
+            << std::endl;
+    }
+    return ss.str();
+}
+
+/**
+ * Pseudo-random, but deterministic value in [0.5,1] of a coalition, which does
+ * not depend on the order of agents
+ */
+double coalitionBenchmarkValue(const AtomicAgent::List& coalition)
+{
+    size_t hash = 0;
+    for(const AtomicAgent& agent : coalition)
+    {
+        hash += std::hash<std::string>()(agent.getModel().toString() + "#" + std::to_string(agent.getId()));
+    }
+    hash *= 1099511628211ull;
+    hash ^= hash >> 29;
+    return 0.5 + (hash % 1000)/2000.0;
+}
+
+/**
+ * Micro-benchmark of the coalition structure generation, i.e. the search of
+ * the integer partition subspaces, for a growing number of agents of three
+ * agent models
+ * \param epochs Number of repetitions per number of agents
+ */
+std::string runCoalitionStructureGenerationBenchmark(size_t epochs)
+{
+    std::vector<IRI> models = { vocabulary::OM::resolve("Sherpa"),
+        vocabulary::OM::resolve("CREX"),
+        vocabulary::OM::resolve("Payload") };
+
+    utils::CoalitionStructureGeneration::CoalitionStructureValueFunction structureValue =
+        [](const utils::CoalitionStructure& structure)
+        {
+            double value = 1.0;
+            for(const AtomicAgent::List& coalition : structure)
+            {
+                value = std::min(value, coalitionBenchmarkValue(coalition));
+            }
+            return value;
+        };
+
+    std::stringstream ss;
+    ss << "# coalition structure generation: time in seconds" << std::endl;
+    ss << "# [number of agents] [value] [prepare time] [search time] [searched nodes] [nodes per s]" << std::endl;
+    for(size_t numberOfAgents = 10; numberOfAgents <= 18; ++numberOfAgents)
+    {
+        AtomicAgent::List agents;
+        for(size_t i = 0; i < numberOfAgents; ++i)
+        {
+            agents.push_back( AtomicAgent(i/models.size(), models[i%models.size()]) );
+        }
+
+        double prepareTime = 0;
+        double searchTime = 0;
+        size_t searchedNodes = 0;
+        double value = 0;
+        size_t repetitions = std::max<size_t>(epochs, 1);
+        for(size_t e = 0; e < repetitions; ++e)
+        {
+            base::Time start = base::Time::now();
+            utils::CoalitionStructureGeneration csg(agents, coalitionBenchmarkValue, structureValue);
+            prepareTime += (base::Time::now() - start).toSeconds();
+
+            start = base::Time::now();
+            csg.findBest(1.0);
+            searchTime += (base::Time::now() - start).toSeconds();
+
+            searchedNodes += csg.getStatistics().searchedNodes;
+            value = csg.currentBestSolutionValue();
+        }
+
+        ss << std::setw(4) << numberOfAgents << " "
+            << std::setw(8) << value << " "
+            << std::setw(12) << prepareTime/repetitions << " "
+            << std::setw(12) << searchTime/repetitions << " "
+            << std::setw(10) << searchedNodes/repetitions << " "
+            << std::setw(12) << (searchTime > 0 ? searchedNodes/searchTime : 0)
+            << std::endl;
+    }
+    return ss.str();
+}
+
 void printUsage(char** argv)
 {
     std::cout << "usage: " << argv[0] << std::endl;
@@ -197,9 +566,12 @@ void printUsage(char** argv)
     std::cout << "    -m <number-of-minimum-feasible-solutions>"  << std::endl;
     std::cout << "    -s <test-specification-file>" << std::endl;
     std::cout << "    -l <logfile-to-generate> (default is /tmp/organization-model-benchmark.log)" << std::endl;
-    std::cout << "    -t <benchmark-type: functional_saturation (fsat) or connectivity (con)" << std::endl;
+    std::cout << "    -t <benchmark-type: functional_saturation (fsat), connectivity (con), tuning of the connectivity search (tune)" << std::endl;
+    std::cout << "        property constraint merging (pcs) or coalition structure generation (csg), which require no organization model" << std::endl;
     std::cout << "    -c <configuration-file>" << std::endl;
+    std::cout << "    -b <best-configuration-file-to-generate> (tuning only, default is /tmp/organization-model-benchmark-best-configuration.xml)" << std::endl;
     std::cout << "    -a <abort/timeout in s>" << std::endl;
+    std::cout << "    -k <number-of-seeds> (connectivity only, run with the fixed seeds 0..k-1 and report median and percentiles)" << std::endl;
 }
 
 
@@ -214,12 +586,14 @@ int main(int argc, char** argv)
     std::string configurationFile;
     std::string specfile;
     std::string logfile = "/tmp/organization-model-benchmark.log";
+    std::string bestConfigurationFile = "/tmp/organization-model-benchmark-best-configuration.xml";
     size_t epochs = 1;
     size_t minFeasible = 1;
     std::string type = "con";
     size_t timeoutInS = 60;
     size_t neighbourHoodSize = 0;
-    while((c = getopt(argc,argv, "o:e:m:s:l:t:c:a:n:")) != -1)
+    size_t numberOfSeeds = 0;
+    while((c = getopt(argc,argv, "o:e:m:s:l:t:c:a:n:b:k:")) != -1)
     {
         if(optarg)
         {
@@ -230,6 +604,11 @@ int main(int argc, char** argv)
                     timeoutInS = boost::lexical_cast<size_t>(optarg);
                     break;
                 }
+                case 'b':
+                {
+                    bestConfigurationFile = optarg;
+                    break;
+                }
                 case 'c':
                 {
                     configurationFile = optarg;
@@ -277,9 +656,18 @@ int main(int argc, char** argv)
                     } else if(type == "connectivity")
                     {
                         type = "con";
+                    } else if(type == "tuning")
+                    {
+                        type = "tune";
+                    } else if(type == "property_constraints")
+                    {
+                        type = "pcs";
+                    } else if(type == "coalition_structure_generation")
+                    {
+                        type = "csg";
                     }
 
-                    if(!(type == "con" || type == "fsat"))
+                    if(!(type == "con" || type == "fsat" || type == "tune" || type == "pcs" || type == "csg"))
                     {
                         std::cout << "Error: test type '" << type << "' unknown" << std::endl;
                         printUsage(argv);
@@ -292,9 +680,25 @@ int main(int argc, char** argv)
                     neighbourHoodSize = boost::lexical_cast<size_t>(optarg);
                     break;
                 }
+                case 'k':
+                {
+                    numberOfSeeds = boost::lexical_cast<size_t>(optarg);
+                    break;
+                }
             }
         }
     }
+    if(type == "pcs" || type == "csg")
+    {
+        std::string log = type == "pcs" ? runPropertyConstraintBenchmark(epochs) : runCoalitionStructureGenerationBenchmark(epochs);
+        std::cout << log << std::endl;
+        std::ofstream saveLog(logfile, std::ofstream::out);
+        saveLog << log;
+        saveLog.close();
+        std::cout << "Save into: " << logfile << std::endl;
+        return 0;
+    }
+
     if(filename.empty() && specfile.empty())
     {
         std::cout << "No file or specfile given" << std::endl;
@@ -343,13 +747,32 @@ int main(int argc, char** argv)
         log << "timeout in s: " << timeoutInS << std::endl;
         log << "# number of epochs: " << epochs << std::endl;
         log << "# minfeasible: " << minFeasible << std::endl;
-        log << "# [model #] " << algebra::Connectivity::Statistics::getStatsDescription() << std::endl;
+        log << "# number of seeds: " << numberOfSeeds << std::endl;
+        log << "# [model #] " << algebra::Connectivity::Statistics::getStatsDescription();
+        if(numberOfSeeds > 0)
+        {
+            std::string fields = algebra::Connectivity::Statistics::getFieldDescription();
+            log << " median: " << fields << " 10th percentile: " << fields << " 90th percentile: " << fields;
+        }
+        log << std::endl;
 
         ModelPoolIterator mit(spec.from, spec.to, spec.stepSize);
         while(mit.next())
         {
             ModelPool current = mit.current();
-            std::vector<algebra::Connectivity::Statistics> stats = runModelPoolTest(om, current, epochs, minFeasible, timeoutInS);
+            std::vector<algebra::Connectivity::Statistics> stats;
+            if(numberOfSeeds == 0)
+            {
+                stats = runModelPoolTest(om, current, epochs, minFeasible, timeoutInS);
+            } else {
+                for(size_t seed = 0; seed < numberOfSeeds; ++seed)
+                {
+                    algebra::Connectivity::setSeed(seed);
+                    std::vector<algebra::Connectivity::Statistics> seedStats = runModelPoolTest(om, current, epochs, minFeasible, timeoutInS, true);
+                    stats.insert(stats.end(), seedStats.begin(), seedStats.end());
+                }
+                algebra::Connectivity::setSeed(-1);
+            }
 
             std::vector<numeric::Stats<double> > numericStats = algebra::Connectivity::Statistics::compute(stats);
             // record the number of model instances
@@ -366,6 +789,16 @@ int main(int argc, char** argv)
                     << s.stdev()
                     << " ";
             }
+            if(numberOfSeeds > 0)
+            {
+                for(double quantile : { 0.5, 0.1, 0.9 })
+                {
+                    for(double value : algebra::Connectivity::Statistics::compute(stats, quantile))
+                    {
+                        log << value << " ";
+                    }
+                }
+            }
             log << std::endl;
         }
     } else if(type == "fsat")
@@ -402,6 +835,35 @@ int main(int argc, char** argv)
             log << neighbourHoodSize << " ";
             log << std::endl;
         }
+    } else if(type == "tune")
+    {
+        log << "from: " << spec.from.toString(4) << std::endl;
+        log << "to: " << spec.to.toString(4) << std::endl;
+        log << "step: " << spec.stepSize.toString(4) << std::endl;
+        log << "timeout in s: " << timeoutInS << std::endl;
+        log << "# number of epochs: " << epochs << std::endl;
+        log << "# minfeasible: " << minFeasible << std::endl;
+
+        std::vector<SearchConfiguration> configurations = getSearchConfigurations();
+        std::vector<TuningResult> results;
+        for(size_t i = 0; i < configurations.size(); ++i)
+        {
+            std::cout << "Configuration #" << i << "/" << configurations.size()
+                << ": " << configurations[i].toString() << std::endl;
+            results.push_back( runTuning(om, spec, configurations[i], epochs, minFeasible, timeoutInS) );
+        }
+        // Restore the user provided configuration
+        algebra::Connectivity::setConfiguration(configuration);
+
+        std::stable_sort(results.begin(), results.end());
+        log << toString(results);
+
+        if(!results.empty() && results.front().supported)
+        {
+            results.front().configuration.save(bestConfigurationFile);
+            std::cout << "Best configuration: " << results.front().configuration.toString() << std::endl;
+            std::cout << "Saved into: " << bestConfigurationFile << std::endl;
+        }
     }
 
     std::cout << log.str() << std::endl;
@@ -21,6 +21,39 @@ OrganizationModel::OrganizationModel(const std::string& filename)
     }
 }
 
+OrganizationModel::OrganizationModel(const OrganizationModel& other)
+    : mpOntology(other.mpOntology)
+    , mQueryCache(other.mQueryCache)
+{
+    boost::unique_lock<boost::mutex> lock(other.mInterfaceCompatibilityMutex);
+    mInterfaceCompatibility = other.mInterfaceCompatibility;
+}
+
+OrganizationModel& OrganizationModel::operator=(const OrganizationModel& other)
+{
+    if(this != &other)
+    {
+        mpOntology = other.mpOntology;
+        mQueryCache = other.mQueryCache;
+
+        std::map<IRI, shared_ptr<const algebra::InterfaceCompatibility> > tables;
+        {
+            boost::unique_lock<boost::mutex> lock(other.mInterfaceCompatibilityMutex);
+            tables = other.mInterfaceCompatibility;
+        }
+        boost::unique_lock<boost::mutex> lock(mInterfaceCompatibilityMutex);
+        mInterfaceCompatibility.swap(tables);
+    }
+    return *this;
+}
+
+void OrganizationModel::resetQueryCache()
+{
+    mQueryCache.clear();
+    boost::unique_lock<boost::mutex> lock(mInterfaceCompatibilityMutex);
+    mInterfaceCompatibility.clear();
+}
+
 OrganizationModel OrganizationModel::copy() const
 {
     OrganizationModel om;
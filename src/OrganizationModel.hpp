@@ -2,6 +2,7 @@
 #define ORGANIZATION_MODEL_ORGANIZATION_MODEL_HPP
 
 #include <stdint.h>
+#include <boost/thread/mutex.hpp>
 #include <moreorg/SharedPtr.hpp>
 #include <owlapi/model/OWLOntology.hpp>
 #include "FunctionalityMapping.hpp"
@@ -13,6 +14,10 @@ namespace moreorg {
 class OrganizationModelAsk;
 class OrganizationModelTell;
 
+namespace algebra {
+    class InterfaceCompatibility;
+}
+
 typedef std::vector<owlapi::model::IRIList> CandidatesList;
 
 /**
@@ -62,6 +67,9 @@ public:
      */
     explicit OrganizationModel(const std::string& filename = "");
 
+    OrganizationModel(const OrganizationModel& other);
+    OrganizationModel& operator=(const OrganizationModel& other);
+
     owlapi::model::OWLOntology::Ptr ontology() { return mpOntology; }
 
     const owlapi::model::OWLOntology::Ptr ontology() const { return mpOntology; }
@@ -90,7 +98,7 @@ public:
     /**
      * Reset / Clear the query cache
      */
-    void resetQueryCache() { mQueryCache.clear(); }
+    void resetQueryCache();
 
 private:
     /// Ontology that serves as basis for this organization model
@@ -98,6 +106,12 @@ private:
 
 protected:
     QueryCache mQueryCache;
+
+    /// Compatibility relation per interface base class
+    /// \see OrganizationModelAsk::getInterfaceCompatibility
+    std::map<owlapi::model::IRI, shared_ptr<const algebra::InterfaceCompatibility> > mInterfaceCompatibility;
+    /// Guard the lazy creation of compatibility tables by concurrent queries
+    mutable boost::mutex mInterfaceCompatibilityMutex;
 };
 
 } // end namespace moreorg
@@ -96,6 +96,7 @@ void OrganizationModelAsk::prepare(const ModelPool& modelPool, bool applyFunctio
     mModelPool = allowSubclasses(modelPool, vocabulary::OM::Actor());
     mModelPool = mModelPool.compact();
     mFunctionalityMapping = computeFunctionalityMapping(mModelPool, applyFunctionalSaturationBound);
+    reasoning::ResourceMatch::prepareSupportTable(mModelPool, getFunctionalities(), mpOrganizationModel->ontology());
 }
 
 owlapi::model::IRIList OrganizationModelAsk::getAgentModels() const
@@ -1403,9 +1404,35 @@ bool OrganizationModelAsk::isFeasible(const ModelPool& modelPool,
             );
 }
 
+algebra::InterfaceCompatibility::Ptr OrganizationModelAsk::getInterfaceCompatibility(const owlapi::model::IRI& interfaceBaseClass) const
+{
+    if(!mpOrganizationModel)
+    {
+        return make_shared<algebra::InterfaceCompatibility>(mOntologyAsk, interfaceBaseClass);
+    }
+
+    // Queries might run concurrently, e.g. when evaluating coalitions in
+    // parallel
+    boost::unique_lock<boost::mutex> lock(mpOrganizationModel->mInterfaceCompatibilityMutex);
+    std::map<owlapi::model::IRI, algebra::InterfaceCompatibility::Ptr>& tables =
+        mpOrganizationModel->mInterfaceCompatibility;
+    std::map<owlapi::model::IRI, algebra::InterfaceCompatibility::Ptr>::const_iterator cit =
+        tables.find(interfaceBaseClass);
+    if(cit != tables.end())
+    {
+        return cit->second;
+    }
+
+    algebra::InterfaceCompatibility::Ptr compatibility =
+        make_shared<algebra::InterfaceCompatibility>(mOntologyAsk, interfaceBaseClass);
+    tables[interfaceBaseClass] = compatibility;
+    return compatibility;
+}
+
 ModelPool::List OrganizationModelAsk::findFeasibleCoalitionStructure(const ModelPool& modelPool,
         const Resource::Set& resourceSet,
-        double feasibilityCheckTimeoutInMs
+        double feasibilityCheckTimeoutInMs,
+        size_t numberOfThreads
         )
 {
     std::pair<ModelPool::List, bool> result = mpOrganizationModel->mQueryCache.getCachedResult(modelPool, resourceSet);
@@ -1414,26 +1441,44 @@ ModelPool::List OrganizationModelAsk::findFeasibleCoalitionStructure(const Model
         return result.first;
     }
 
+    // The pools supporting the resources are the same for all coalitions
+    ModelPool::Set supportPools = getIntersection(resourceSet);
+
     AtomicAgent::List agents = AtomicAgent::toList(modelPool);
-    utils::CoalitionStructureGeneration csg(agents,
-            [this, resourceSet, feasibilityCheckTimeoutInMs](const AtomicAgent::List& agents) -> double
+    // Coalition values are shared between the search and the coalition
+    // structure value function
+    utils::CoalitionValueCache::Ptr coalitionValues = make_shared<utils::CoalitionValueCache>(
+            [this, &supportPools, feasibilityCheckTimeoutInMs](const AtomicAgent::List& agents) -> double
             {
                 ModelPool pool = AtomicAgent::getModelPool(agents);
-                if(isSupporting(pool, resourceSet,
-                            feasibilityCheckTimeoutInMs))
-
+                // see isSupporting
+                ModelPool::Set::const_iterator pit = std::find_if(supportPools.begin(), supportPools.end(),
+                        [&pool](const ModelPool& other)
+                        {
+                            return Algebra::isSubset(other, pool);
+                        });
+                if(pit == supportPools.end())
                 {
-                    return 1.0;
+                    return 0.0;
                 }
-                return 0.0;
-            },
-            [this, resourceSet, feasibilityCheckTimeoutInMs](const std::vector<AtomicAgent::List>& csg) -> double
+
+                // The feasibility of a coalition does not depend on the
+                // resources, so that the cached result of algebra::Connectivity
+                // is reused across queries
+                return isFeasible(pool, feasibilityCheckTimeoutInMs) ? 1.0 : 0.0;
+            });
+    // Create the interface compatibility table before the coalitions are
+    // evaluated in parallel, since this queries the ontology
+    getInterfaceCompatibility(mInterfaceBaseClass);
+    coalitionValues->precompute(agents, agents.size(), numberOfThreads);
+
+    utils::CoalitionStructureGeneration csg(agents,
+            coalitionValues,
+            [coalitionValues](const std::vector<AtomicAgent::List>& csg) -> double
             {
                 for(const AtomicAgent::List& agents : csg)
                 {
-                    ModelPool pool = AtomicAgent::getModelPool(agents);
-                    if(!isSupporting(pool, resourceSet,
-                                feasibilityCheckTimeoutInMs))
+                    if(coalitionValues->getValue(agents) == 0.0)
                     {
                         return 0.0;
                     }
@@ -1441,6 +1486,7 @@ ModelPool::List OrganizationModelAsk::findFeasibleCoalitionStructure(const Model
                 return 1.0;
 
             });
+    csg.setNumberOfThreads(numberOfThreads);
 
     ModelPool::List coalitionStructure;
     std::vector<AtomicAgent::List> solution = csg.findBest(1.0);
@@ -1452,6 +1498,9 @@ ModelPool::List OrganizationModelAsk::findFeasibleCoalitionStructure(const Model
         }
     }
 
+    LOG_DEBUG_S << "Coalition value cache: " << coalitionValues->size() << " entries, "
+        << coalitionValues->getHits() << " hits, " << coalitionValues->getMisses() << " misses";
+
     mpOrganizationModel->mQueryCache.cacheResult(modelPool, resourceSet, coalitionStructure);
     return coalitionStructure;
 }
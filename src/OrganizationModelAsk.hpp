@@ -7,6 +7,7 @@
 #include "SharedPtr.hpp"
 #include "OrganizationModel.hpp"
 #include "algebra/ResourceSupportVector.hpp"
+#include "algebra/InterfaceCompatibility.hpp"
 #include "Algebra.hpp"
 #include "vocabularies/OM.hpp"
 
@@ -324,6 +325,17 @@ public:
      */
     OrganizationModel::Ptr getOrganizationModel() const { return mpOrganizationModel; }
 
+    /**
+     * Get the compatibility relation between the interfaces of the
+     * organization model
+     * The relation is computed only once per organization model and
+     * interface base class and shared by all callers
+     * \param interfaceBaseClass Base class of the interfaces
+     * \return compatibility relation
+     */
+    algebra::InterfaceCompatibility::Ptr getInterfaceCompatibility(const owlapi::model::IRI& interfaceBaseClass =
+            vocabulary::OM::resolve("ElectroMechanicalInterface")) const;
+
     /**
      * Get the functionality mapping of the current OrganizationModelAsk object
      * \return FunctionalityMapping
@@ -419,10 +431,16 @@ public:
     /**
      * Find a feasible coalition structure where all systems support a list of
      * functionality
+     *
+     * The feasibility of the coalitions is cached by algebra::Connectivity,
+     * so that queries with overlapping model pools can reuse it
+     * \param numberOfThreads Number of threads to evaluate the coalitions and
+     * to search the coalition structures with, 0 to use one thread per core
      */
     ModelPool::List findFeasibleCoalitionStructure(const ModelPool& modelPool,
             const Resource::Set& supportedResourceSet,
-            double feasibilityCheckTimeoutInMs);
+            double feasibilityCheckTimeoutInMs,
+            size_t numberOfThreads = 1);
 
     /**
       * Get all property values describing a component a an agent model
@@ -1,10 +1,87 @@
 #include "PropertyConstraintSolver.hpp"
+#include <algorithm>
 #include <gecode/minimodel.hh>
 #include <base-logging/Logging.hpp>
 #include "facades/Robot.hpp"
 
 namespace moreorg {
 
+namespace {
+
+/**
+ * Interval of a single property, where the bounds might be exclusive
+ */
+struct Interval
+{
+    double min;
+    double max;
+    bool minExclusive;
+    bool maxExclusive;
+
+    Interval()
+        : min(Gecode::Float::Limits::min)
+        , max(Gecode::Float::Limits::max)
+        , minExclusive(false)
+        , maxExclusive(false)
+    {}
+
+    void upperBound(double value, bool exclusive)
+    {
+        if(value < max)
+        {
+            max = value;
+            maxExclusive = exclusive;
+        } else if(value == max)
+        {
+            maxExclusive = maxExclusive || exclusive;
+        }
+    }
+
+    void lowerBound(double value, bool exclusive)
+    {
+        if(value > min)
+        {
+            min = value;
+            minExclusive = exclusive;
+        } else if(value == min)
+        {
+            minExclusive = minExclusive || exclusive;
+        }
+    }
+
+    /**
+     * Intersect with the values fulfilling a constraint
+     * \return False if the interval becomes empty
+     */
+    bool constrain(PropertyConstraint::ConstraintType type, double value)
+    {
+        switch(type)
+        {
+            case PropertyConstraint::EQUAL:
+                lowerBound(value, false);
+                upperBound(value, false);
+                break;
+            case PropertyConstraint::LESS_EQUAL:
+                upperBound(value, false);
+                break;
+            case PropertyConstraint::LESS_THAN:
+                upperBound(value, true);
+                break;
+            case PropertyConstraint::GREATER_EQUAL:
+                lowerBound(value, false);
+                break;
+            case PropertyConstraint::GREATER_THAN:
+                lowerBound(value, true);
+                break;
+            default:
+                break;
+        }
+        return min < max || (min == max && !minExclusive && !maxExclusive);
+    }
+};
+
+} // end anonymous namespace
+
 PropertyConstraintSolver::PropertyConstraintSolver()
     : Gecode::Space()
 {}
@@ -36,6 +113,56 @@ ValueBound PropertyConstraintSolver::merge(const PropertyConstraint::List& const
 }
 
 ValueBound PropertyConstraintSolver::merge(const PropertyConstraint::Set& constraints)
+{
+    if(usesPropertyReference(constraints))
+    {
+        return mergeCSP(constraints);
+    }
+    return mergeIntervals(constraints);
+}
+
+bool PropertyConstraintSolver::usesPropertyReference(const PropertyConstraint::Set& constraints)
+{
+    for(const PropertyConstraint& constraint : constraints)
+    {
+        if(constraint.usesPropertyReference())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+ValueBound PropertyConstraintSolver::mergeIntervals(const PropertyConstraint::Set& constraints)
+{
+    std::map<owlapi::model::IRI, Interval> intervals;
+    for(const PropertyConstraint& constraint : constraints)
+    {
+        Interval& interval = intervals[constraint.getProperty()];
+        if(!interval.constrain(constraint.getType(), constraint.getValue()))
+        {
+            throw std::invalid_argument("moreorg::PropertyConstraintSolver: constraints cannot be fulfilled");
+        }
+    }
+
+    double minValue = 0;
+    double maxValue = Gecode::Float::Limits::max;
+    for(const std::map<owlapi::model::IRI, Interval>::value_type& p : intervals)
+    {
+        minValue = std::max(minValue, p.second.min);
+        maxValue = std::min(maxValue, p.second.max);
+    }
+    if(minValue > maxValue)
+    {
+        throw
+            std::invalid_argument("moreorg::PropertyConstraintSolver:"
+                    " constraints cannot be fulfilled - required min >"
+                    " required max");
+    }
+    return ValueBound(minValue, maxValue);
+}
+
+ValueBound PropertyConstraintSolver::mergeCSP(const PropertyConstraint::Set& constraints)
 {
     PropertyConstraintSolver propertyConstraintSolver;
 
@@ -107,6 +234,28 @@ Fulfillment PropertyConstraintSolver::fulfills(const facades::Robot& robot,
 Fulfillment PropertyConstraintSolver::fulfills(const facades::Robot& robot,
         const PropertyConstraint::Set& constraints)
 {
+    if(!usesPropertyReference(constraints))
+    {
+        // Property values are fixed, so that each constraint can be
+        // checked separately
+        std::map<owlapi::model::IRI, Interval> intervals;
+        for(const PropertyConstraint& constraint : constraints)
+        {
+            std::map<owlapi::model::IRI, Interval>::iterator it = intervals.find(constraint.getProperty());
+            if(it == intervals.end())
+            {
+                Interval interval;
+                interval.constrain(PropertyConstraint::EQUAL, robot.getPropertyValue(constraint.getProperty()));
+                it = intervals.insert(std::make_pair(constraint.getProperty(), interval)).first;
+            }
+            if(!it->second.constrain(constraint.getType(), constraint.getValue()))
+            {
+                return Fulfillment(false, constraints);
+            }
+        }
+        return Fulfillment(true, {});
+    }
+
     PropertyConstraintSolver propertyConstraintSolver;
 
     PropertyConstraint::Set conflicts;
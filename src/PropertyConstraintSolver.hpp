@@ -51,11 +51,33 @@ public:
 
     /**
      * Merge a list of constraints a returns the corresponding allowed value bound
+     * Constraints without property references are merged in closed form
+     * (see mergeIntervals), otherwise using Gecode (see mergeCSP)
      * \return ValueBound The allowed value range
      * \throws std::invalid_argument when constraints cannot be fulfilled
      */
     static ValueBound merge(const PropertyConstraint::Set& constraints);
 
+    /**
+     * Merge constraints by intersecting the intervals per property
+     * This is valid only for constraints without property references
+     * \return ValueBound The allowed value range
+     * \throws std::invalid_argument when constraints cannot be fulfilled
+     */
+    static ValueBound mergeIntervals(const PropertyConstraint::Set& constraints);
+
+    /**
+     * Merge constraints by propagating a Gecode float space
+     * \return ValueBound The allowed value range
+     * \throws std::invalid_argument when constraints cannot be fulfilled
+     */
+    static ValueBound mergeCSP(const PropertyConstraint::Set& constraints);
+
+    /**
+     * Check if any of the constraints refers to another property
+     */
+    static bool usesPropertyReference(const PropertyConstraint::Set& constraints);
+
     /**
      * Test a list of constraints
      * \param robot Robot reference to dynamically resolve property values for * composite systems
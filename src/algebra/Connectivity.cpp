@@ -6,23 +6,33 @@
 #include <gecode/search.hh>
 #include <graph_analysis/GraphIO.hpp>
 #include <iostream>
+#include <algorithm>
 
+#include "ConnectivityPropagator.hpp"
 #include "../vocabularies/OM.hpp"
 #include "../utils/GecodeUtils.hpp"
+#include "../utils/UnionFind.hpp"
 
 using namespace owlapi::model;
 
 namespace moreorg {
 namespace algebra {
 
+boost::shared_mutex Connectivity::msQueryCacheMutex;
 QueryCache Connectivity::msQueryCache;
+boost::mutex Connectivity::msWitnessLibrariesMutex;
+boost::mutex Connectivity::msOntologyMutex;
+std::map<std::pair<IRI, IRI>, ConnectivityWitnessLibrary> Connectivity::msWitnessLibraries;
 
-Connectivity::Statistics Connectivity::msStatistics;
-graph_analysis::BaseGraph::Ptr Connectivity::msConnectionGraph;
+thread_local Connectivity::Statistics Connectivity::msStatistics;
+thread_local graph_analysis::BaseGraph::Ptr Connectivity::msConnectionGraph;
 qxcfg::Configuration Connectivity::msConfiguration;
+int64_t Connectivity::msSeed = -1;
 
 Connectivity::Statistics::Statistics()
     : evaluations(0)
+    , timeInS(0)
+    , stopped(0)
 {}
 
 std::string Connectivity::Statistics::toString(size_t indent) const
@@ -42,6 +52,26 @@ std::string Connectivity::Statistics::toString(size_t indent) const
     return ss.str();
 }
 
+std::vector<double> Connectivity::Statistics::toVector() const
+{
+    std::vector<double> values;
+    values.push_back(evaluations);
+    values.push_back(timeInS);
+    values.push_back(stopped);
+    values.push_back(csp.propagate);
+    values.push_back(csp.fail);
+    values.push_back(csp.node);
+    values.push_back(csp.depth);
+    values.push_back(csp.restart);
+    values.push_back(csp.nogood);
+    return values;
+}
+
+std::string Connectivity::Statistics::getFieldDescription()
+{
+    return "[graph completeness eval][time in s][stopped][# propagator executions][# failed nodes][# expanded nodes][# depth of search stack][# restarts][# nogoods]";
+}
+
 std::string Connectivity::Statistics::getStatsDescription()
 {
     return "[graph completeness eval][stdev][time in s][stdev][stopped][stdev][# propagator executions][stdev][# failed nodes][stdev][# expanded nodes][stdev][# depth of search stack][stdev][# restarts][stdev][# nogoods][stdev]";
@@ -53,35 +83,61 @@ std::vector< numeric::Stats<double> > Connectivity::Statistics::compute(const st
 
     for(const Connectivity::Statistics& s : statistics)
     {
-        size_t i = 0;
-        stats[i++].update(s.evaluations);
-        stats[i++].update(s.timeInS);
-        stats[i++].update(s.stopped);
-        stats[i++].update(s.csp.propagate);
-        stats[i++].update(s.csp.fail);
-        stats[i++].update(s.csp.node);
-        stats[i++].update(s.csp.depth);
-        stats[i++].update(s.csp.depth);
-        stats[i++].update(s.csp.nogood);
+        std::vector<double> values = s.toVector();
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            stats[i].update(values[i]);
+        }
     }
     return stats;
 }
 
+std::vector<double> Connectivity::Statistics::compute(const std::vector<Connectivity::Statistics>& statistics, double quantile)
+{
+    if(quantile < 0 || quantile > 1)
+    {
+        throw std::invalid_argument("moreorg::algebra::Connectivity::Statistics::compute: quantile must be in [0,1]");
+    }
+
+    std::vector<double> quantiles(9, 0.0);
+    if(statistics.empty())
+    {
+        return quantiles;
+    }
+
+    std::vector< std::vector<double> > samples(quantiles.size());
+    for(const Connectivity::Statistics& s : statistics)
+    {
+        std::vector<double> values = s.toVector();
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            samples[i].push_back(values[i]);
+        }
+    }
+
+    // Linear interpolation between the closest ranks
+    double position = quantile*(statistics.size() - 1);
+    size_t lower = static_cast<size_t>(position);
+    size_t upper = std::min(lower + 1, statistics.size() - 1);
+    double weight = position - lower;
+    for(size_t i = 0; i < samples.size(); ++i)
+    {
+        std::sort(samples[i].begin(), samples[i].end());
+        quantiles[i] = (1 - weight)*samples[i][lower] + weight*samples[i][upper];
+    }
+    return quantiles;
+}
+
 std::string Connectivity::Statistics::toString(const std::vector<Connectivity::Statistics>& statistics)
 {
     std::stringstream ss;
-    ss << "[graph completeness eval][time in s][stopped][# propagator executions][# failed nodes][# expanded nodes][# depth of search stack][# restarts][# nogoods]" << std::endl;
+    ss << getFieldDescription() << std::endl;
     for(const Connectivity::Statistics& s : statistics)
     {
-        ss << s.evaluations << " ";
-        ss << s.timeInS << " ";
-        ss << s.stopped << " ";
-        ss << s.csp.propagate << " ";
-        ss << s.csp.fail << " ";
-        ss << s.csp.node << " ";
-        ss << s.csp.depth << " ";
-        ss << s.csp.restart << " ";
-        ss << s.csp.nogood << " ";
+        for(double value : s.toVector())
+        {
+            ss << value << " ";
+        }
         ss << std::endl;
     }
 
@@ -99,45 +155,74 @@ std::string Connectivity::Statistics::toString(const std::vector<Connectivity::S
     return ss.str();
 }
 
+Connectivity::Structure::Structure(const ModelPool& modelPool,
+        const owlapi::model::OWLOntologyAsk& ask,
+        const InterfaceCompatibility::Ptr& compatibility,
+        const owlapi::model::IRI& interfaceBaseClass,
+        const owlapi::model::IRI& property)
+    : modelPool(modelPool.compact())
+    , ask(ask)
+    , compatibility(compatibility)
+    , interfaceBaseClass(interfaceBaseClass)
+    , property(property)
+    , modelCombination(this->modelPool.toModelCombination())
+{}
+
 Connectivity::Connectivity(const ModelPool& modelPool,
         const OrganizationModelAsk& ask,
         const owlapi::model::IRI& interfaceBaseClass,
         const owlapi::model::IRI& property
         )
-    : mModelPool(modelPool.compact())
-    , mAsk(ask.ontology())
-    , mInterfaceBaseClass(interfaceBaseClass)
-    , mProperty(property)
-    , mModelCombination(mModelPool.toModelCombination())
-    , mExistingConnections(*this, mModelCombination.size(), 0, mModelCombination.size())
-    , mAgentConnections(*this, mModelCombination.size()*mModelCombination.size(), 0, mModelCombination.size())
+    : Connectivity(modelPool, ask, interfaceBaseClass, property, NULL)
+{}
+
+Connectivity::Connectivity(const ModelPool& modelPool,
+        const OrganizationModelAsk& ask,
+        const owlapi::model::IRI& interfaceBaseClass,
+        const owlapi::model::IRI& property,
+        const ConnectivityWitness* warmStart
+        )
+    : mpStructure(make_shared<Structure>(modelPool, ask.ontology(),
+                ask.getInterfaceCompatibility(interfaceBaseClass),
+                interfaceBaseClass, property))
     , mRnd(0)
     , mIsTree(true)
 {
-    // Using hw() potentially requires entropy generator
-    // since Gecode uses /dev/random, which might block
-    // whilw time seem to be rather low resolution it seems now the better
-    // option
-    //mRnd.time();
-    mRnd.hw();
+    // A fixed seed makes the search reproducible, e.g., for benchmarking
+    int64_t seed = msSeed;
+    if(seed < 0)
+    {
+        seed = std::stoll(msConfiguration.getValue("connectivity/search/seed", "-1"));
+    }
+    if(seed >= 0)
+    {
+        mRnd.seed(static_cast<unsigned int>(seed));
+    } else {
+        // Using hw() potentially requires entropy generator
+        // since Gecode uses /dev/random, which might block
+        // whilw time seem to be rather low resolution it seems now the better
+        // option
+        //mRnd.time();
+        mRnd.hw();
+    }
     identifyInterfaces();
+    identifyLinks();
 
-    Gecode::IntVarArray connections(*this, mInterfaces.size()*mInterfaces.size(),0,1);
-    enforceSymmetricMatrix(connections);
-    applyCompatibilityConstraints(connections);
-    cacheExistingConnections(connections);
-    maxOneLink(connections);
+    size_t numberOfAgents = mpStructure->modelCombination.size();
+    mConnections = Gecode::IntVarArray(*this, mpStructure->idx2Interfaces.size(), 0, 1);
+    mExistingConnections = Gecode::IntVarArray(*this, numberOfAgents, 0, numberOfAgents);
+    mAgentConnections = Gecode::IntVarArray(*this, mpStructure->agentIdx2Agents.size(), 0, 1);
 
-    mConnections = connections;
+    enforceLinkCount();
+    applyAgentConstraints();
+    cacheExistingConnections();
+    maxOneLink();
+    enforceConnectivity();
 
     LOG_INFO_S << "Connectivity: after initial propagation" << toString();
 
-    // Avoid computation of solutions that are redunant
-    // Gecode documentation says however in 8.10.2 that "Symmetry breaking by
-    // LDSB is not guaranteed to be complete. That is, a search may still return
-    // two distinct solutions that are symmetric."
-    //
-    Gecode::Symmetries symmetries = identifySymmetries(connections);
+    // Avoid computation of solutions that are redundant
+    breakSymmetries();
 
     std::string valueSelection = msConfiguration.getValue("connectivity/branching/value-selection", "MAX");
     Gecode::IntValBranch::Select valSelect = utils::GecodeUtils::getIntValSelect(valueSelection);
@@ -179,13 +264,23 @@ Connectivity::Connectivity(const ModelPool& modelPool,
             varBranch = new Gecode::IntVarBranch(varSelect, nullptr);
             break;
         default:
+            delete valBranch;
             throw std::runtime_error("moreorg::algebra::Connectivity: selected value selection"
                 " strategy is not supported: '" + variableSelection + "'");
 
 
     }
 
-    branch(*this, mConnections, *varBranch, *valBranch, symmetries);
+    if(warmStart)
+    {
+        // Try the links of the previous solution first
+        Gecode::IntVarArgs previousLinks = getLinks(*warmStart);
+        if(previousLinks.size() > 0)
+        {
+            branch(*this, previousLinks, Gecode::INT_VAR_NONE(), Gecode::INT_VAL_MAX());
+        }
+    }
+    branch(*this, mConnections, *varBranch, *valBranch);
     //branch(*this, mConnections, Gecode::INT_VAR_RND(mRnd), Gecode::INT_VAL_MAX());
 
     delete valBranch;
@@ -194,13 +289,7 @@ Connectivity::Connectivity(const ModelPool& modelPool,
 
 Connectivity::Connectivity(Connectivity& other)
     : Gecode::Space(other)
-    , mModelPool(other.mModelPool)
-    , mAsk(other.mAsk)
-    , mModelCombination(other.mModelCombination)
-    , mInterfaces(other.mInterfaces)
-    , mInterfaceMapping(other.mInterfaceMapping)
-    , mInterfaceIndexRanges(other.mInterfaceIndexRanges)
-    , mIdx2Agents(other.mIdx2Agents)
+    , mpStructure(other.mpStructure)
     , mRnd(other.mRnd)
     , mIsTree(other.mIsTree)
 {
@@ -209,211 +298,202 @@ Connectivity::Connectivity(Connectivity& other)
     mExistingConnections.update(*this, other.mExistingConnections);
 }
 
-void Connectivity::identifyInterfaces()
+IRIList Connectivity::getInterfaces(const owlapi::model::OWLOntologyAsk& ask,
+        const IRI& model,
+        const IRI& interfaceBaseClass,
+        const IRI& property)
 {
-    assert(!mModelCombination.empty());
-    // Identify interfaces -- we assume here ElectroMechanicalInterface
-    IRIList::const_iterator mit = mModelCombination.begin();
-    for(; mit != mModelCombination.end(); ++mit)
+    std::vector<OWLCardinalityRestriction::Ptr> restrictions;
     {
-        const IRI& model = *mit;
-        std::vector<OWLCardinalityRestriction::Ptr> restrictions = mAsk.getCardinalityRestrictions(model, mProperty, mInterfaceBaseClass);
+        boost::unique_lock<boost::mutex> lock(msOntologyMutex);
+        restrictions = ask.getCardinalityRestrictions(model, property, interfaceBaseClass);
+    }
 
-        owlapi::model::IRIList interfaces;
-        for(const OWLCardinalityRestriction::Ptr& r : restrictions)
+    owlapi::model::IRIList interfaces;
+    for(const OWLCardinalityRestriction::Ptr& r : restrictions)
+    {
+        const OWLObjectCardinalityRestriction::Ptr& restriction = dynamic_pointer_cast<OWLObjectCardinalityRestriction>(r);
+        if(!restriction)
         {
-            const OWLObjectCardinalityRestriction::Ptr& restriction = dynamic_pointer_cast<OWLObjectCardinalityRestriction>(r);
-            if(!restriction)
-            {
-                throw
-                    std::runtime_error("moreorg::algebra::Connectivity::identifyInterfaces:"
-                        " expected OWLObjectCardinalityRestriction");
-            }
+            throw
+                std::runtime_error("moreorg::algebra::Connectivity::getInterfaces:"
+                    " expected OWLObjectCardinalityRestriction");
+        }
 
-            if( restriction->getCardinalityRestrictionType() == OWLCardinalityRestriction::MAX)
+        if( restriction->getCardinalityRestrictionType() == OWLCardinalityRestriction::MAX)
+        {
+            for(size_t i = 0; i < restriction->getCardinality(); ++i)
             {
-                for(size_t i = 0; i < restriction->getCardinality(); ++i)
-                {
-                    interfaces.push_back(restriction->getQualification());
-                }
-            } else {
-                LOG_INFO_S << "Found a minimum cardinality restriction "
-                    << restriction->getQualification() << " on model " << model
-                    << " -- was expecting a max cardinality constraint";
+                interfaces.push_back(restriction->getQualification());
             }
+        } else {
+            LOG_INFO_S << "Found a minimum cardinality restriction "
+                << restriction->getQualification() << " on model " << model
+                << " -- was expecting a max cardinality constraint";
+        }
+    }
+    return interfaces;
+}
+
+void Connectivity::identifyInterfaces()
+{
+    Structure& structure = *mpStructure;
+    assert(!structure.modelCombination.empty());
+    // Identify interfaces -- we assume here ElectroMechanicalInterface
+    IRIList::const_iterator mit = structure.modelCombination.begin();
+    for(; mit != structure.modelCombination.end(); ++mit)
+    {
+        const IRI& model = *mit;
+
+        // Instances of the same model are enumerated consecutively, so
+        // that interfaces have to be identified only once per model
+        if(!structure.interfaceMapping.empty() && structure.interfaceMapping.back().first == model)
+        {
+            std::pair<IRI, IRIList> interfacesOfModel = structure.interfaceMapping.back();
+            uint32_t startRange = structure.interfaces.size();
+            structure.interfaces.insert(structure.interfaces.end(), interfacesOfModel.second.begin(), interfacesOfModel.second.end());
+            uint32_t endRange = structure.interfaces.size() - 1;
+            structure.interfaceIndexRanges.push_back( IndexRange(startRange, endRange) );
+            structure.interfaceMapping.push_back(interfacesOfModel);
+            continue;
         }
 
+        owlapi::model::IRIList interfaces = getInterfaces(structure.ask, model,
+                structure.interfaceBaseClass, structure.property);
         if(interfaces.empty())
         {
             throw NoConnectionInterfaces("moreorg::algebra::Connecticity:"
-                    " cannot construct problem since model '" + model.toString() + "' does not have any associated interfaces of type '" + mInterfaceBaseClass.toString() );
+                    " cannot construct problem since model '" + model.toString() + "' does not have any associated interfaces of type '" + structure.interfaceBaseClass.toString() );
         }
 
         std::pair<IRI, IRIList> interfacesOfModel(model, interfaces);
-        uint32_t startRange = mInterfaces.size();
-        mInterfaces.insert(mInterfaces.end(), interfaces.begin(), interfaces.end());
-        uint32_t endRange = mInterfaces.size() - 1;
+        uint32_t startRange = structure.interfaces.size();
+        structure.interfaces.insert(structure.interfaces.end(), interfaces.begin(), interfaces.end());
+        uint32_t endRange = structure.interfaces.size() - 1;
 
         // for each model register start + end index so that we can define the
         // constraints between different systems more easily
-        mInterfaceIndexRanges.push_back( IndexRange(startRange, endRange) );
-        mInterfaceMapping.push_back(interfacesOfModel);
+        structure.interfaceIndexRanges.push_back( IndexRange(startRange, endRange) );
+        structure.interfaceMapping.push_back(interfacesOfModel);
     }
 
-    for(size_t idx = 0; idx < mInterfaces.size()*mInterfaces.size(); ++idx)
+    structure.interface2Agent.reserve(structure.interfaces.size());
+    for(size_t a = 0; a < structure.interfaceIndexRanges.size(); ++a)
     {
-        size_t a1Idx = idx%mInterfaces.size();
-        size_t a0Idx = (idx - a1Idx)/mInterfaces.size();
-
-        IndexRange idxRange0;
-        IndexRange idxRange1;
-
-        for(IndexRange range : mInterfaceIndexRanges)
-        {
-            if(a0Idx >= range.first && a0Idx <= range.second)
-            {
-                idxRange0 = range;
-            }
-            if(a1Idx >= range.first && a1Idx <= range.second )
-            {
-                idxRange1 = range;
-            }
-        }
-
-        size_t agent0 = std::distance(mInterfaceIndexRanges.begin(), std::find(mInterfaceIndexRanges.begin(), mInterfaceIndexRanges.end(),idxRange0));
-        size_t agent1 = std::distance(mInterfaceIndexRanges.begin(), std::find(mInterfaceIndexRanges.begin(), mInterfaceIndexRanges.end(),idxRange1));
-
-        mIdx2Agents.push_back( std::pair<size_t,size_t>(agent0,agent1) );
+        const IndexRange& range = structure.interfaceIndexRanges[a];
+        structure.interface2Agent.insert(structure.interface2Agent.end(),
+                range.second - range.first + 1, a);
     }
-}
 
-void Connectivity::enforceSymmetricMatrix(Gecode::IntVarArray& connections)
-{
-    Gecode::Matrix<Gecode::IntVarArray> connectionMatrix(connections, mInterfaces.size(), mInterfaces.size());
-    //          a0-0 a0-1 a0-2 a0-3 a1-0   a1-1   a1-2
-    //  a0-0     [0]  [0]  [0]  [0] [0,1]  [0,1]  [0,1]
-    //  a0-1     [0]  [0]
-    //  a0-2     [0]       [0]
-    //  a0-3                    [0]
-    //  a1-0                        [0]
-    //  a1-1                             [0]
-    //  a1-2                                   [0]
-
-    /// Symmetry of matrix -- since if interface A is compatible to B, so is B
-    /// compatible to A
-    Gecode::IntVarArgs exactNumberOfConnections;
-    for(uint32_t s = 0; s < mInterfaces.size(); ++s)
+    // Interfaces outside of the interface hierarchy get an id that is
+    // compatible with no other interface, i.e. they are no link candidates
+    structure.interface2Id.reserve(structure.interfaces.size());
+    for(const IRI& interfaceModel : structure.interfaces)
     {
-        for(uint32_t t = s; t < mInterfaces.size(); ++t)
+        size_t id = structure.compatibility->findId(interfaceModel);
+        if(id == InterfaceCompatibility::UNKNOWN_ID)
         {
-            Gecode::IntVar v = connectionMatrix(s,t);
-            Gecode::IntVar vSym = connectionMatrix(t,s);
-
-            rel(*this, v == vSym);
-            if(t == s)
-            {
-                rel(*this, v, Gecode::IRT_EQ, 0);
-            }
-
-            exactNumberOfConnections << v;
+            LOG_DEBUG_S << "Interface " << interfaceModel << " is not a known interface of type " << structure.compatibility->getInterfaceBaseClass();
         }
-    }
-
-    Gecode::IntVar linkCount(*this, mInterfaceIndexRanges.size()-1, mInterfaceIndexRanges.size());
-    if(mIsTree)
-    {
-        rel(*this, sum(exactNumberOfConnections) == linkCount);
-    } else {
-        rel(*this, sum(exactNumberOfConnections) >= linkCount);
+        structure.interface2Id.push_back(id);
     }
 }
 
-void Connectivity::applyCompatibilityConstraints(Gecode::IntVarArray& connections)
+void Connectivity::identifyLinks()
 {
-    Gecode::Matrix<Gecode::IntVarArray> connectionMatrix(connections, mInterfaces.size(), mInterfaces.size());
+    Structure& structure = *mpStructure;
+    structure.interface2Idx.resize(structure.interfaces.size());
 
-    // for all interfaces check compatibility and set domain (0) or (0,1)
-    // accordingly 1 means connection (can be) established
+    // for all interfaces check compatibility, only compatible interfaces
+    // of different agents lead to a link candidate, i.e. a variable
     // Agent A
-    for(size_t a0 = 0; a0 < mInterfaceIndexRanges.size(); ++a0)
+    for(size_t a0 = 0; a0 < structure.interfaceIndexRanges.size(); ++a0)
     {
-        IndexRange a0InterfaceIndexes = mInterfaceIndexRanges[a0];
+        IndexRange a0InterfaceIndexes = structure.interfaceIndexRanges[a0];
         // Agent B
-        for(size_t a1 = a0; a1 < mInterfaceIndexRanges.size(); ++a1)
+        for(size_t a1 = a0 + 1; a1 < structure.interfaceIndexRanges.size(); ++a1)
         {
-            IndexRange a1InterfaceIndexes = mInterfaceIndexRanges[a1];
-
-            Gecode::IntVarArgs agentInterconnection;
+            IndexRange a1InterfaceIndexes = structure.interfaceIndexRanges[a1];
+            std::vector<uint32_t> agentInterconnection;
 
             // Interfaces of Agent A
-            for(size_t i0 = a0InterfaceIndexes.first; i0 <= a0InterfaceIndexes.second; ++i0)
+            for(uint32_t i0 = a0InterfaceIndexes.first; i0 <= a0InterfaceIndexes.second; ++i0)
             {
-                const IRI& interfaceModel0 = mInterfaces[i0];
+                const IRI& interfaceModel0 = structure.interfaces[i0];
 
                 // Interfaces of Agent B
-                for(size_t i1 = a1InterfaceIndexes.first; i1 <= a1InterfaceIndexes.second; ++i1)
+                for(uint32_t i1 = a1InterfaceIndexes.first; i1 <= a1InterfaceIndexes.second; ++i1)
                 {
-                    const IRI& interfaceModel1 = mInterfaces[i1];
-
-                    Gecode::IntVar v = connectionMatrix(i0,i1);
-                    agentInterconnection << v;
+                    const IRI& interfaceModel1 = structure.interfaces[i1];
 
-                    if(a1 == a0) // same agent
+                    if(!structure.compatibility->isCompatible(structure.interface2Id[i0], structure.interface2Id[i1]))
                     {
-                        LOG_DEBUG_S << "Same agents that shall be connected";
-                        // no connection possible within the same agent
-                        rel(*this, v, Gecode::IRT_EQ, 0);
-                    } else {
-                        bool hasRelation = false;
-                        try {
-                            hasRelation = mAsk.isRelatedTo(interfaceModel0,
-                                    vocabulary::OM::compatibleWith(),
-                                    interfaceModel1);
-                        } catch(const std::invalid_argument& e)
-                        {
-                            LOG_INFO_S << "No relation found between " <<
-                                interfaceModel0 << " and " << interfaceModel1 <<
-                                " -- " << e.what();
-                            // seems there is not even an individual for this
-                            // interface type
-                        }
-
-                        if(hasRelation)
-                        {
-                            LOG_DEBUG_S << interfaceModel0.toString() << " isCompatibleWith " << interfaceModel1.toString();
-                            rel(*this, v, Gecode::IRT_LQ,1);
-                        } else {
-                            // no connection possible between these two models
-                            LOG_DEBUG_S << interfaceModel0.toString() << " isNotCompatibleWith " << interfaceModel1.toString();
-                            rel(*this, v, Gecode::IRT_EQ, 0);
-                        }
+                        // no connection possible between these two models
+                        LOG_DEBUG_S << interfaceModel0.toString() << " isNotCompatibleWith " << interfaceModel1.toString();
+                        continue;
                     }
+                    LOG_DEBUG_S << interfaceModel0.toString() << " isCompatibleWith " << interfaceModel1.toString();
+
+                    uint32_t idx = structure.idx2Interfaces.size();
+                    structure.idx2Interfaces.push_back( std::pair<uint32_t, uint32_t>(i0, i1) );
+                    structure.idx2Agents.push_back( std::pair<size_t, size_t>(a0, a1) );
+                    structure.interface2Idx[i0].push_back(idx);
+                    structure.interface2Idx[i1].push_back(idx);
+                    agentInterconnection.push_back(idx);
                 }
             }
-            // There should be maximum one connection between two systems
-            rel(*this, sum( agentInterconnection ) <= 1);
-            Gecode::Matrix<Gecode::IntVarArray> agentConnectionMatrix(mAgentConnections, mModelCombination.size(), mModelCombination.size());
-            rel(*this, agentConnectionMatrix(a0, a1) == sum( agentInterconnection ) );
+
+            if(!agentInterconnection.empty())
+            {
+                structure.agentIdx2Agents.push_back( std::pair<size_t, size_t>(a0, a1) );
+                structure.agentIdx2Idx.push_back(agentInterconnection);
+            }
         }
     }
+}
 
+void Connectivity::enforceLinkCount()
+{
+    int linkCount = static_cast<int>(mpStructure->interfaceIndexRanges.size()) - 1;
+    if(mIsTree)
+    {
+        rel(*this, sum(mConnections) == linkCount);
+    } else {
+        rel(*this, sum(mConnections) >= linkCount);
+    }
 }
 
-void Connectivity::cacheExistingConnections(Gecode::IntVarArray& connections)
+void Connectivity::applyAgentConstraints()
 {
-    Gecode::Matrix<Gecode::IntVarArray> connectionMatrix(connections, mInterfaces.size(), mInterfaces.size());
+    // There should be maximum one connection between two systems, which is
+    // enforced by the domain of the agent connection
+    for(size_t agentIdx = 0; agentIdx < mpStructure->agentIdx2Idx.size(); ++agentIdx)
+    {
+        Gecode::IntVarArgs agentInterconnection;
+        for(uint32_t idx : mpStructure->agentIdx2Idx[agentIdx])
+        {
+            agentInterconnection << mConnections[idx];
+        }
+        rel(*this, mAgentConnections[agentIdx] == sum( agentInterconnection ) );
+    }
+}
 
+void Connectivity::cacheExistingConnections()
+{
     // This constraint implicitly holds through the other constraints
     // of # of overall links, agent interconnection and max one connection per
     // interface
-    for(size_t a = 0; a < mInterfaceIndexRanges.size(); ++a)
+    for(size_t a = 0; a < mpStructure->interfaceIndexRanges.size(); ++a)
     {
-        IndexRange aInterfaceIndexes = mInterfaceIndexRanges[a];
+        IndexRange aInterfaceIndexes = mpStructure->interfaceIndexRanges[a];
         Gecode::IntVarArgs agentConnections;
         // Interfaces of Agent A
         for(size_t i = aInterfaceIndexes.first; i <= aInterfaceIndexes.second; ++i)
         {
-            agentConnections << connectionMatrix.col(i);
+            for(uint32_t idx : mpStructure->interface2Idx[i])
+            {
+                agentConnections << mConnections[idx];
+            }
         }
 
         // there should be at least one outgoing connection to another system
@@ -422,19 +502,21 @@ void Connectivity::cacheExistingConnections(Gecode::IntVarArray& connections)
     }
 }
 
-void Connectivity::maxOneLink(Gecode::IntVarArray& connections)
+void Connectivity::maxOneLink()
 {
-    Gecode::Matrix<Gecode::IntVarArray> connectionMatrix(connections, mInterfaces.size(), mInterfaces.size());
-
     // Maximum of one connection per interface
-    for(size_t c = 0; c < mInterfaces.size(); ++c)
+    for(size_t i = 0; i < mpStructure->interfaces.size(); ++i)
     {
-        Gecode::IntVarArgs interfaceUsage;
+        const std::vector<uint32_t>& indices = mpStructure->interface2Idx[i];
+        if(indices.size() < 2)
+        {
+            continue;
+        }
 
-        for(size_t r = 0; r < mInterfaces.size(); ++r)
+        Gecode::IntVarArgs interfaceUsage;
+        for(uint32_t idx : indices)
         {
-            Gecode::IntVar v = connectionMatrix(c,r);
-            interfaceUsage << v;
+            interfaceUsage << mConnections[idx];
         }
 
         // There should be maximum one connection per interface
@@ -442,84 +524,185 @@ void Connectivity::maxOneLink(Gecode::IntVarArray& connections)
     }
 }
 
-Gecode::Space* Connectivity::copy()
+void Connectivity::enforceConnectivity()
 {
-    return new Connectivity(*this);
+    Gecode::IntArgs endpoints;
+    for(const std::pair<size_t, size_t>& agents : mpStructure->agentIdx2Agents)
+    {
+        endpoints << static_cast<int>(agents.first) << static_cast<int>(agents.second);
+    }
+    connected(*this, mAgentConnections, endpoints, mpStructure->modelCombination.size(), mIsTree);
 }
 
-bool Connectivity::isComplete() const
+void Connectivity::breakSymmetries()
 {
-    Gecode::Matrix<Gecode::IntVarArray> connectionMatrix(mConnections, mInterfaces.size(), mInterfaces.size());
-
-    using namespace graph_analysis;
-    Vertex::PtrList vertices;
-    // Currently testing connectivity is implemented only for lemon
-    mpBaseGraph = BaseGraph::getInstance(BaseGraph::LEMON_DIRECTED_GRAPH);
-    for(size_t i = 0; i < mInterfaceMapping.size(); ++i)
+    const Structure& structure = *mpStructure;
+
+    // Agents of the same model are interchangeable. Permuting them maps one
+    // solution to another and permutes the following per agent profile
+    // accordingly: number of existing connections, followed by the link
+    // variables to agents of other models, ordered by (other agent, own
+    // interface, other interface)
+    // Hence, requiring the profiles of agents of the same model to be
+    // lexicographically ordered keeps at least one solution of each
+    // equivalence class
+    std::vector< std::vector< std::tuple<size_t, uint32_t, uint32_t, uint32_t> > > profiles(structure.modelCombination.size());
+    for(uint32_t idx = 0; idx < structure.idx2Interfaces.size(); ++idx)
     {
-        Vertex::Ptr v =
-            make_shared<Vertex>(mInterfaceMapping[i].first.getFragment());
-        mpBaseGraph->addVertex(v);
+        const std::pair<size_t, size_t>& agents = structure.idx2Agents[idx];
+        if(structure.modelCombination[agents.first] == structure.modelCombination[agents.second])
+        {
+            continue;
+        }
 
-        vertices.push_back(v);
+        const std::pair<uint32_t, uint32_t>& interfaces = structure.idx2Interfaces[idx];
+        uint32_t offset0 = interfaces.first - structure.interfaceIndexRanges[agents.first].first;
+        uint32_t offset1 = interfaces.second - structure.interfaceIndexRanges[agents.second].first;
+        profiles[agents.first].push_back( std::make_tuple(agents.second, offset0, offset1, idx) );
+        profiles[agents.second].push_back( std::make_tuple(agents.first, offset1, offset0, idx) );
     }
 
-    for(size_t a0 = 0; a0 < mInterfaceIndexRanges.size() - 1 ; ++a0)
+    for(size_t a = 1; a < structure.modelCombination.size(); ++a)
     {
-        IndexRange a0InterfaceIndexes = mInterfaceIndexRanges[a0];
-
-        for(size_t a1 = a0+1; a1 < mInterfaceIndexRanges.size(); ++a1)
+        if(structure.modelCombination[a-1] != structure.modelCombination[a])
         {
-            IndexRange a1InterfaceIndexes = mInterfaceIndexRanges[a1];
+            continue;
+        }
 
-            bool connectionFound = false;
-            // check if any of the interface link has a value of one:
-            // Interfaces of Agent A
-            for(size_t i0 = a0InterfaceIndexes.first; i0 <= a0InterfaceIndexes.second; ++i0)
-            {
-                const IRI& interfaceModel0 = mInterfaces[i0];
+        std::sort(profiles[a-1].begin(), profiles[a-1].end());
+        std::sort(profiles[a].begin(), profiles[a].end());
 
-                // Interfaces of Agent B
-                for(size_t i1 = a1InterfaceIndexes.first; i1 <= a1InterfaceIndexes.second; ++i1)
-                {
-                    const IRI& interfaceModel1 = mInterfaces[i1];
+        Gecode::IntVarArgs previous;
+        Gecode::IntVarArgs current;
+        previous << mExistingConnections[a-1];
+        current << mExistingConnections[a];
+        for(size_t p = 0; p < profiles[a].size(); ++p)
+        {
+            previous << mConnections[ std::get<3>(profiles[a-1][p]) ];
+            current << mConnections[ std::get<3>(profiles[a][p]) ];
+        }
+        rel(*this, previous, Gecode::IRT_GQ, current);
+    }
+}
 
-                    Gecode::IntVar v = connectionMatrix(i0,i1);
-                    if(!v.assigned())
-                    {
-                        throw std::runtime_error("moreorg::algebra::Connectivity::checkGraphCompleteness: expected value to be assiged");
-                    }
+Gecode::IntVarArgs Connectivity::getLinks(const ConnectivityWitness& witness) const
+{
+    const Structure& structure = *mpStructure;
 
-                    if(v.val() == 1)
-                    {
-                        // connection exists between these two systems
-                        connectionFound = true;
-                        Edge::Ptr e0 =
-                            make_shared<Edge>(vertices[a0],vertices[a1]);
-                        e0->setLabel(interfaceModel0.getFragment());
-                        Edge::Ptr e1 =
-                            make_shared<Edge>(vertices[a1],vertices[a0]);
-                        e1->setLabel(interfaceModel1.getFragment());
-                        mpBaseGraph->addEdge(e0);
-                        mpBaseGraph->addEdge(e1);
-                        break;
-                    }
-                }
+    std::map< std::pair<uint32_t, uint32_t>, uint32_t> interfaces2Idx;
+    for(uint32_t idx = 0; idx < structure.idx2Interfaces.size(); ++idx)
+    {
+        interfaces2Idx[ structure.idx2Interfaces[idx] ] = idx;
+    }
 
-                if(connectionFound)
+    // The n-th agent of a model in the witness corresponds to the n-th agent
+    // of this model in the model combination
+    std::vector<int> witnessAgent2Agent(witness.getNumberOfAgents(), -1);
+    std::map<IRI, size_t> instanceCount;
+    for(uint32_t a = 0; a < witness.getNumberOfAgents(); ++a)
+    {
+        size_t instance = instanceCount[witness.getModel(a)]++;
+        for(size_t agent = 0; agent < structure.interfaceMapping.size(); ++agent)
+        {
+            if(structure.interfaceMapping[agent].first == witness.getModel(a))
+            {
+                if(instance == 0)
                 {
+                    witnessAgent2Agent[a] = agent;
                     break;
                 }
+                --instance;
             }
         }
     }
 
-    if(!mpBaseGraph->isConnected())
+    Gecode::IntVarArgs links;
+    for(const ConnectivityWitness::Link& link : witness.getLinks())
     {
-        return false;
-    } else {
-        return true;
+        int agent0 = witnessAgent2Agent[link.agent0];
+        int agent1 = witnessAgent2Agent[link.agent1];
+        if(agent0 < 0 || agent1 < 0)
+        {
+            continue;
+        }
+        const IndexRange& range0 = structure.interfaceIndexRanges[agent0];
+        const IndexRange& range1 = structure.interfaceIndexRanges[agent1];
+        uint32_t i0 = range0.first + link.interface0;
+        uint32_t i1 = range1.first + link.interface1;
+        if(i0 > range0.second || i1 > range1.second)
+        {
+            continue;
+        }
+
+        std::map< std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator cit =
+            interfaces2Idx.find(std::make_pair(std::min(i0,i1), std::max(i0,i1)));
+        if(cit != interfaces2Idx.end())
+        {
+            links << mConnections[cit->second];
+        }
+    }
+    return links;
+}
+
+Gecode::Space* Connectivity::copy()
+{
+    return new Connectivity(*this);
+}
+
+bool Connectivity::isComplete() const
+{
+    const Structure& structure = *mpStructure;
+
+    utils::UnionFind components(structure.interfaceMapping.size());
+    for(size_t idx = 0; idx < structure.idx2Agents.size(); ++idx)
+    {
+        const Gecode::IntVar& v = mConnections[idx];
+        if(!v.assigned())
+        {
+            throw std::runtime_error("moreorg::algebra::Connectivity::isComplete: expected value to be assiged");
+        }
+
+        if(v.val() == 1)
+        {
+            // connection exists between these two systems
+            const std::pair<size_t, size_t>& agents = structure.idx2Agents[idx];
+            components.merge(agents.first, agents.second);
+        }
     }
+    return components.getNumberOfSets() == 1;
+}
+
+ConnectivityWitness Connectivity::toWitness() const
+{
+    const Structure& structure = *mpStructure;
+
+    ConnectivityWitness witness;
+    for(size_t i = 0; i < structure.interfaceMapping.size(); ++i)
+    {
+        witness.addAgent(structure.interfaceMapping[i].first,
+                structure.interfaceMapping[i].second);
+    }
+
+    for(size_t idx = 0; idx < structure.idx2Interfaces.size(); ++idx)
+    {
+        const Gecode::IntVar& v = mConnections[idx];
+        if(!v.assigned())
+        {
+            throw std::runtime_error("moreorg::algebra::Connectivity::toWitness: expected value to be assiged");
+        }
+
+        if(v.val() == 1)
+        {
+            // connection exists between these two systems
+            const std::pair<size_t, size_t>& agents = structure.idx2Agents[idx];
+            const std::pair<uint32_t, uint32_t>& interfaces = structure.idx2Interfaces[idx];
+            witness.addLink(agents.first,
+                    interfaces.first - structure.interfaceIndexRanges[agents.first].first,
+                    agents.second,
+                    interfaces.second - structure.interfaceIndexRanges[agents.second].first);
+        }
+    }
+    return witness;
 }
 
 bool Connectivity::isFeasible(const ModelPool& modelPool,
@@ -528,7 +711,7 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
         const owlapi::model::IRI& interfaceBaseClass)
 {
     msConnectionGraph.reset();
-    return Connectivity::isFeasible(modelPool, ask, msConnectionGraph, timeoutInMs, minFeasible, interfaceBaseClass);
+    return checkFeasibility(modelPool, ask, NULL, timeoutInMs, minFeasible, interfaceBaseClass);
 }
 
 bool Connectivity::isFeasible(const ModelPool& modelPool,
@@ -537,38 +720,89 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
         double timeoutInMs, size_t minFeasible,
         const owlapi::model::IRI& interfaceBaseClass)
 {
-    FeasibilityQuery query = std::make_tuple(modelPool,
-            ask.ontology().getOntology()->getIRI(),
-            interfaceBaseClass,
-            timeoutInMs,
-            minFeasible);
+    bool feasible = checkFeasibility(modelPool, ask, &baseGraph, timeoutInMs, minFeasible, interfaceBaseClass);
+    msConnectionGraph = baseGraph;
+    return feasible;
+}
 
-    QueryCache::const_iterator cit = msQueryCache.find(query);
-    if(cit != msQueryCache.end())
+bool Connectivity::isFeasibleDelta(const ModelPool& basePool,
+        const ConnectivityWitness& baseWitness,
+        const ModelPoolDelta& delta,
+        const OrganizationModelAsk& ask,
+        ConnectivityWitness& witness,
+        double timeoutInMs,
+        const owlapi::model::IRI& interfaceBaseClass)
+{
+    if(baseWitness.getModelPool() != basePool.compact())
     {
-        std::pair<graph_analysis::BaseGraph::Ptr, bool> cachedResult = cit->second;
-        baseGraph = cachedResult.first;
-        return cachedResult.second;
+        throw std::invalid_argument("moreorg::algebra::Connectivity::isFeasibleDelta: "
+                " witness does not correspond to the base model pool");
     }
 
-    // For a single system this check is trivially true
-    size_t numberOfInstances = modelPool.numberOfInstances();
-    if(numberOfInstances == 0)
+    ModelPool additions;
+    ModelPool removals;
+    ModelPool modelPool = basePool;
+    for(const ModelPoolDelta::value_type& v : delta)
     {
-        throw std::invalid_argument("moreorg::algebra::Connectivity::isFeasible: "
-                " the given model pool has a model count of 0");
-    } else if(modelPool.numberOfInstances() == 1)
+        int count = static_cast<int>(basePool.getValue(v.first, 0)) + v.second;
+        if(count < 0)
+        {
+            throw std::invalid_argument("moreorg::algebra::Connectivity::isFeasibleDelta: "
+                    " cannot remove more agents of type '" + v.first.toString() + "' than available");
+        }
+        modelPool[v.first] = count;
+        if(v.second > 0)
+        {
+            additions[v.first] = v.second;
+        } else if(v.second < 0)
+        {
+            removals[v.first] = -v.second;
+        }
+    }
+    modelPool = modelPool.compact();
+    if(modelPool.numberOfInstances() == 0)
     {
-        LOG_DEBUG_S << "An atomic agent is always feasible";
+        throw std::invalid_argument("moreorg::algebra::Connectivity::isFeasibleDelta: "
+                " the resulting model pool has a model count of 0");
+    }
+
+    msStatistics = Statistics();
+    base::Time startTime = base::Time::now();
+
+    // Local repair of the witness
+    InterfaceCompatibility::Ptr compatibility = ask.getInterfaceCompatibility(interfaceBaseClass);
+    owlapi::model::OWLOntologyAsk ontologyAsk = ask.ontology();
+    ConnectivityWitness::InterfaceProvider interfaceProvider =
+        [ontologyAsk, interfaceBaseClass](const IRI& model)
+        {
+            return getInterfaces(ontologyAsk, model, interfaceBaseClass);
+        };
+
+    ConnectivityWitness repaired = baseWitness;
+    if(repaired.reduce(removals, *compatibility) &&
+            repaired.extend(additions, *compatibility, interfaceProvider))
+    {
+        LOG_DEBUG_S << "Connection is feasible: repaired witness " << repaired.toString(4);
+        msStatistics.timeInS = (base::Time::now() - startTime).toSeconds();
+        witness = repaired;
         return true;
     }
 
-    msStatistics.evaluations = 0;
+    if(modelPool.numberOfInstances() == 1)
+    {
+        const IRI& model = modelPool.begin()->first;
+        witness = ConnectivityWitness();
+        witness.addAgent(model, interfaceProvider(model));
+        return true;
+    }
+
+    // Search, but try the links that remain from the base witness first
+    ConnectivityWitness previous = baseWitness;
+    previous.reduce(removals, *compatibility);
 
-    Connectivity* last = NULL;
     Connectivity* connectivity = NULL;
     try {
-        connectivity = new Connectivity(modelPool, ask, interfaceBaseClass);
+        connectivity = new Connectivity(modelPool, ask, interfaceBaseClass, vocabulary::OM::has(), &previous);
     } catch(const NoConnectionInterfaces& e)
     {
         LOG_INFO_S << "No connection interfaces of type '" <<
@@ -576,35 +810,58 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
         return false;
     }
 
+    bool isComplete = false;
+    Connectivity* solution = search(connectivity, timeoutInMs, 1, isComplete);
+    if(solution && isComplete)
+    {
+        witness = solution->toWitness();
+    }
+    delete solution;
+    return isComplete;
+}
+
+Connectivity* Connectivity::search(Connectivity* connectivity,
+        double timeoutInMs,
+        size_t minFeasible,
+        bool& isComplete)
+{
     Gecode::Search::Options options;
     if(timeoutInMs > 0)
     {
         options.stop = Gecode::Search::Stop::time(timeoutInMs);
     }
-    options.nogoods_limit = 1024;
-    //Gecode::Search::Cutoff * c = Gecode::Search::Cutoff::geometric(10,2);
-    Gecode::Search::Cutoff * c = Gecode::Search::Cutoff::constant(10);
+    options.nogoods_limit = std::stoul(msConfiguration.getValue("connectivity/search/nogoods-limit", "1024"));
+    std::string cutoff = msConfiguration.getValue("connectivity/search/cutoff", "CONSTANT");
+    unsigned long cutoffScale = std::stoul(msConfiguration.getValue("connectivity/search/cutoff-scale", "10"));
     //Gecode::Rnd rnd;
     //rnd.hw();
     //Gecode::Search::Cutoff * c = Gecode::Search::Cutoff::rnd(rnd.seed(),1,connectivity->mInterfaces.size(),2);
-    options.cutoff = c;
+    try {
+        options.cutoff = utils::GecodeUtils::getCutoff(cutoff, cutoffScale);
+    } catch(...)
+    {
+        delete connectivity;
+        throw;
+    }
     Gecode::RBS<Connectivity, Gecode::DFS> searchEngine(connectivity, options);
+    delete connectivity;
     //Gecode::BAB<Connectivity> searchEngine(connectivity, options);
 
-    bool isComplete = false;
+    isComplete = false;
     size_t feasibleSolutions = 0;
+    // The last evaluated solution, which determines the result and from
+    // which the connection graph is created on request
+    Connectivity* solution = NULL;
     Connectivity* current = NULL;
     base::Time startTime = base::Time::now();
     try {
         while((current = searchEngine.next()))
         {
             ++msStatistics.evaluations;
+            delete solution;
+            solution = current;
 
             isComplete = current->isComplete();
-            baseGraph = current->mpBaseGraph->clone();
-            delete last;
-            last = NULL;
-
             if(isComplete)
             {
                 LOG_DEBUG_S << "Connection is feasible: found solution " << current->toString() << std::endl
@@ -615,7 +872,6 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
                     break;
                 }
             }
-            last = current;
         }
     } catch(const std::invalid_argument& e)
     {
@@ -628,91 +884,185 @@ bool Connectivity::isFeasible(const ModelPool& modelPool,
     msStatistics.stopped = searchEngine.stopped();
     msStatistics.csp = searchEngine.statistics();
 
-    delete last;
-    delete current;
-    delete connectivity;
-
-    msQueryCache[query] = std::make_pair(baseGraph, isComplete);
-    return isComplete;
+    return solution;
 }
 
-std::string Connectivity::toString() const
+bool Connectivity::checkFeasibility(const ModelPool& modelPool,
+        const OrganizationModelAsk& ask,
+        graph_analysis::BaseGraph::Ptr* baseGraph,
+        double timeoutInMs, size_t minFeasible,
+        const owlapi::model::IRI& interfaceBaseClass)
 {
-    std::stringstream ss;
-    std::vector< std::pair<size_t, size_t> > links;
-    Gecode::Matrix<Gecode::IntVarArray> connectionMatrix(mConnections, mInterfaces.size(), mInterfaces.size());
-    for(uint32_t r = 0; r < mInterfaces.size(); ++r)
+    FeasibilityQuery query = std::make_tuple(modelPool,
+            ask.ontology().getOntology()->getIRI(),
+            interfaceBaseClass,
+            timeoutInMs,
+            minFeasible);
+
     {
-        ss << std::endl << "interface #" << r << " " ;
-        for(uint32_t c = r; c < mInterfaces.size(); ++c)
+        boost::shared_lock<boost::shared_mutex> lock(msQueryCacheMutex);
+        QueryCache::const_iterator cit = msQueryCache.find(query);
+        if(cit != msQueryCache.end())
         {
-            Gecode::IntVar var = connectionMatrix(r,c);
-            ss << "(" << r << "/" << c << ")=" << var << " ";
-            if(var.assigned() && var.val() == 1)
+            const std::pair<graph_analysis::BaseGraph::Ptr, bool>& cachedResult = cit->second;
+            // A cached feasible result might have been computed without
+            // materializing the connection graph
+            if(!baseGraph || cachedResult.first || !cachedResult.second)
             {
-                links.push_back(std::pair<size_t,size_t>(r,c));
+                if(baseGraph)
+                {
+                    *baseGraph = cachedResult.first;
+                }
+                return cachedResult.second;
             }
         }
-        ss << std::endl;
     }
-    ss << "Established links (" << links.size() << "):" << std::endl;
-    for(uint32_t r = 0; r < links.size(); ++r)
+
+    // For a single system this check is trivially true
+    size_t numberOfInstances = modelPool.numberOfInstances();
+    if(numberOfInstances == 0)
     {
-        ss << links[r].first << "/" << links[r].second;
-        ss << std::endl;
+        throw std::invalid_argument("moreorg::algebra::Connectivity::isFeasible: "
+                " the given model pool has a model count of 0");
+    } else if(modelPool.numberOfInstances() == 1)
+    {
+        LOG_DEBUG_S << "An atomic agent is always feasible";
+        return true;
     }
-    return ss.str();
-}
 
-Gecode::Symmetries Connectivity::identifySymmetries(Gecode::IntVarArray& connections)
-{
-    Gecode::Matrix<Gecode::IntVarArray> connectionMatrix(connections, mInterfaces.size(), mInterfaces.size());
+    msStatistics.evaluations = 0;
 
-    Gecode::Symmetries symmetries;
-    // define interchangeable columns for roles of the same model type
-    for(const std::pair<IRI, uint32_t>& entry : mModelPool)
+    // A witness proves the existence of (at least) a single solution
+    bool useWitnessLibrary = minFeasible <= 1 &&
+        msConfiguration.getValue("connectivity/witness-library", "true") != "false";
+    std::pair<IRI, IRI> witnessLibraryKey(ask.ontology().getOntology()->getIRI(), interfaceBaseClass);
+    if(useWitnessLibrary)
     {
-        const IRI& currentModel = entry.first;
-        Gecode::IntVarArgs sameModel;
+        base::Time startTime = base::Time::now();
+        owlapi::model::OWLOntologyAsk ontologyAsk = ask.ontology();
+        ConnectivityWitness::InterfaceProvider interfaceProvider =
+            [ontologyAsk, interfaceBaseClass](const IRI& model)
+            {
+                return getInterfaces(ontologyAsk, model, interfaceBaseClass);
+            };
 
-        size_t numberOfVariables = 0;
-        for(size_t c = 0; c < mInterfaceMapping.size(); ++c)
+        InterfaceCompatibility::Ptr compatibility = ask.getInterfaceCompatibility(interfaceBaseClass);
+        ConnectivityWitness witness;
+        bool found;
         {
-            // check the model of the interface
-            if( mInterfaceMapping[c].first == currentModel)
+            boost::unique_lock<boost::mutex> lock(msWitnessLibrariesMutex);
+            ConnectivityWitnessLibrary& witnessLibrary = msWitnessLibraries[witnessLibraryKey];
+            found = witnessLibrary.find(modelPool, *compatibility, interfaceProvider, witness);
+            if(found)
             {
-                IndexRange interfaceIndexes = mInterfaceIndexRanges[c];
-                LOG_INFO_S << currentModel.toString() << " adding columns: " << interfaceIndexes.first << " -- " << interfaceIndexes.second;
-                for(size_t i = interfaceIndexes.first; i <= interfaceIndexes.second; ++i)
-                {
-                    // Since a single agents spans multiple columns with its
-                    // interface range, we have to dynamically create the length
-                    // field
-                    numberOfVariables += mInterfaces.size();
-                    sameModel << connectionMatrix.col(i);
-                }
+                witnessLibrary.add(witness);
+            }
+        }
+        if(found)
+        {
+            LOG_DEBUG_S << "Connection is feasible: found witness " << witness.toString(4);
+
+            msStatistics.timeInS = (base::Time::now() - startTime).toSeconds();
+            msStatistics.stopped = false;
+            msStatistics.csp = Gecode::Search::Statistics();
+
+            graph_analysis::BaseGraph::Ptr connectionGraph;
+            if(baseGraph)
+            {
+                connectionGraph = witness.toBaseGraph();
+                *baseGraph = connectionGraph;
             }
+            boost::unique_lock<boost::shared_mutex> lock(msQueryCacheMutex);
+            msQueryCache[query] = std::make_pair(connectionGraph, true);
+            return true;
         }
-        symmetries << VariableSequenceSymmetry(sameModel, numberOfVariables);
     }
 
-    Gecode::IntVarArgs rows;
-    for(int r = 0; r < connectionMatrix.height(); r++)
+    Connectivity* connectivity = NULL;
+    try {
+        connectivity = new Connectivity(modelPool, ask, interfaceBaseClass);
+    } catch(const NoConnectionInterfaces& e)
     {
-        rows << connectionMatrix.row(r);
+        LOG_INFO_S << "No connection interfaces of type '" <<
+            interfaceBaseClass << "' found on " << modelPool.toString(4);
+        return false;
     }
-    symmetries << VariableSequenceSymmetry(rows, connectionMatrix.width());
 
-    Gecode::IntVarArgs cols;
-    for(int c = 0; c < connectionMatrix.width(); c++)
+    bool isComplete = false;
+    Connectivity* solution = search(connectivity, timeoutInMs, minFeasible, isComplete);
+
+    graph_analysis::BaseGraph::Ptr connectionGraph;
+    if(solution)
     {
-        cols << connectionMatrix.col(c);
+        if(isComplete)
+        {
+            ConnectivityWitness witness = solution->toWitness();
+            if(useWitnessLibrary)
+            {
+                boost::unique_lock<boost::mutex> lock(msWitnessLibrariesMutex);
+                msWitnessLibraries[witnessLibraryKey].add(witness);
+            }
+            if(baseGraph)
+            {
+                connectionGraph = witness.toBaseGraph();
+            }
+        } else if(baseGraph)
+        {
+            connectionGraph = solution->toWitness().toBaseGraph();
+        }
+
+        if(baseGraph)
+        {
+            *baseGraph = connectionGraph;
+        }
     }
-    symmetries << VariableSequenceSymmetry(cols, connectionMatrix.height());
 
-    return symmetries;
+    delete solution;
+
+    boost::unique_lock<boost::shared_mutex> lock(msQueryCacheMutex);
+    msQueryCache[query] = std::make_pair(connectionGraph, isComplete);
+    return isComplete;
+}
+
+size_t Connectivity::getQueryCacheSize()
+{
+    boost::shared_lock<boost::shared_mutex> lock(msQueryCacheMutex);
+    return msQueryCache.size();
+}
+
+void Connectivity::resetQueryCache()
+{
+    {
+        boost::unique_lock<boost::shared_mutex> lock(msQueryCacheMutex);
+        msQueryCache.clear();
+    }
+    boost::unique_lock<boost::mutex> lock(msWitnessLibrariesMutex);
+    msWitnessLibraries.clear();
 }
 
+std::string Connectivity::toString() const
+{
+    std::stringstream ss;
+    std::vector< std::pair<size_t, size_t> > links;
+    for(uint32_t idx = 0; idx < mpStructure->idx2Interfaces.size(); ++idx)
+    {
+        const std::pair<uint32_t, uint32_t>& interfaces = mpStructure->idx2Interfaces[idx];
+        Gecode::IntVar var = mConnections[idx];
+        ss << "(" << interfaces.first << "/" << interfaces.second << ")=" << var << " ";
+        if(var.assigned() && var.val() == 1)
+        {
+            links.push_back(interfaces);
+        }
+    }
+    ss << std::endl;
+    ss << "Established links (" << links.size() << "):" << std::endl;
+    for(uint32_t r = 0; r < links.size(); ++r)
+    {
+        ss << links[r].first << "/" << links[r].second;
+        ss << std::endl;
+    }
+    return ss.str();
+}
 double Connectivity::merit(const Gecode::Space& space, Gecode::IntVar x, int idx)
 {
     // prefer the less constrained
@@ -722,18 +1072,18 @@ double Connectivity::merit(const Gecode::Space& space, Gecode::IntVar x, int idx
 
 double Connectivity::computeMerit(Gecode::IntVar x, int idx) const
 {
-    std::pair<size_t, size_t> agents = mIdx2Agents[idx];
+    std::pair<size_t, size_t> agents = mpStructure->idx2Agents[idx];
 
     // find number of existing connections for both agents using the
     // cached values
     size_t existingConnections0 = mExistingConnections[agents.first].min();
     size_t existingConnections1 = mExistingConnections[agents.second].min();
 
-    IndexRange idxRange0 = mInterfaceIndexRanges[agents.first];
+    IndexRange idxRange0 = mpStructure->interfaceIndexRanges[agents.first];
     double merit0 = 0;
     size_t numberOfInterfaces0 = idxRange0.second - idxRange0.first + 1;
 
-    IndexRange idxRange1 = mInterfaceIndexRanges[agents.second];
+    IndexRange idxRange1 = mpStructure->interfaceIndexRanges[agents.second];
     double merit1 = 0;
     size_t numberOfInterfaces1 = idxRange1.second - idxRange1.first + 1;
 
@@ -7,10 +7,14 @@
 #include <functional>
 #include <unordered_map>
 #include <tuple>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
 #include <numeric/Stats.hpp>
 #include <graph_analysis/BaseGraph.hpp>
 #include "../OrganizationModelAsk.hpp"
+#include "InterfaceCompatibility.hpp"
+#include "ConnectivityWitness.hpp"
 #include "../vocabularies/OM.hpp"
 #include <qxcfg/Configuration.hpp>
 
@@ -59,66 +63,169 @@ namespace algebra {
  */
 class Connectivity : public Gecode::Space
 {
-    /// Model pool which has to be checked for its connectivity
-    ModelPool mModelPool;
-    /// The organization model
-    owlapi::model::OWLOntologyAsk mAsk;
-
-    owlapi::model::IRI mInterfaceBaseClass;
-    owlapi::model::IRI mProperty;
-
-    // Explicitly enumerated type (in contrast to the cardinality based
-    // representation via ModelPool
-    ModelCombination mModelCombination;
-    owlapi::model::IRIList mInterfaces;
-
-    // Index of interface mapping and interface index range correspond to the
-    // same model instance
-    //
-    /// List the interfaces and associate the list with corresponding model instance
-    /// as such allows to map an agent (as model instance) to the list of
-    //interfaces
-    std::vector< std::pair<owlapi::model::IRI, owlapi::model::IRIList> > mInterfaceMapping;
+    friend class ConnectivityEnumerator;
+
     /// Register the interface index ranges
     typedef std::pair<uint32_t, uint32_t> IndexRange;
-    // Per model instance, list the range of interfaces that are associated with
-    // this model to speed up information access
-    std::vector< IndexRange > mInterfaceIndexRanges;
 
-    /// Map from the index of a (connection) variable to the two agents/index of index ranges
-    std::vector< std::pair<size_t, size_t> > mIdx2Agents;
+    /**
+     * The structure of the problem, which does not change during search and is
+     * therefore shared between all copies of a space
+     *
+     * Link variables exist only for pairs of compatible interfaces (i0,i1)
+     * with i0 < i1 that belong to different agents, so that symmetry,
+     * same-agent and incompatibility constraints hold implicitly
+     */
+    struct Structure
+    {
+        Structure(const ModelPool& modelPool,
+                const owlapi::model::OWLOntologyAsk& ask,
+                const InterfaceCompatibility::Ptr& compatibility,
+                const owlapi::model::IRI& interfaceBaseClass,
+                const owlapi::model::IRI& property);
+
+        /// Model pool which has to be checked for its connectivity
+        ModelPool modelPool;
+        /// The organization model
+        owlapi::model::OWLOntologyAsk ask;
+        /// The (shared) compatibility relation of the interfaces
+        InterfaceCompatibility::Ptr compatibility;
+
+        owlapi::model::IRI interfaceBaseClass;
+        owlapi::model::IRI property;
+
+        // Explicitly enumerated type (in contrast to the cardinality based
+        // representation via ModelPool
+        ModelCombination modelCombination;
+        owlapi::model::IRIList interfaces;
+
+        // Index of interface mapping and interface index range correspond to the
+        // same model instance
+        //
+        /// List the interfaces and associate the list with corresponding model instance
+        /// as such allows to map an agent (as model instance) to the list of
+        //interfaces
+        std::vector< std::pair<owlapi::model::IRI, owlapi::model::IRIList> > interfaceMapping;
+        // Per model instance, list the range of interfaces that are associated with
+        // this model to speed up information access
+        std::vector< IndexRange > interfaceIndexRanges;
+        /// Map from the index of an interface to the agent it belongs to
+        std::vector<uint32_t> interface2Agent;
+        /// Map from the index of an interface to the id of its class
+        /// \see InterfaceCompatibility
+        std::vector<size_t> interface2Id;
+
+        /// Map from the index of a (connection) variable to the two interfaces
+        std::vector< std::pair<uint32_t, uint32_t> > idx2Interfaces;
+        /// Map from the index of a (connection) variable to the two agents/index of index ranges
+        std::vector< std::pair<size_t, size_t> > idx2Agents;
+        /// Map from the index of an interface to the (connection) variables it
+        /// is part of
+        std::vector< std::vector<uint32_t> > interface2Idx;
+
+        /// Map from the index of an agent connection variable to the two
+        /// agents
+        std::vector< std::pair<size_t, size_t> > agentIdx2Agents;
+        /// Map from the index of an agent connection variable to the
+        /// (connection) variables between these agents
+        std::vector< std::vector<uint32_t> > agentIdx2Idx;
+    };
 
-    // |#ofInterface|*a0Idx + a1Idx
+    shared_ptr<Structure> mpStructure;
+
+    /// One variable per link candidate \see Structure::idx2Interfaces
     Gecode::IntVarArray mConnections;
     Gecode::IntVarArray mExistingConnections;
 
-    // Helper class to improve computation of merit function
+    /// One variable per pair of agents that have at least one link candidate
+    /// \see Structure::agentIdx2Agents
     Gecode::IntVarArray mAgentConnections;
 
     // Random number generator
     mutable Gecode::Rnd mRnd;
 
-    mutable graph_analysis::BaseGraph::Ptr mpBaseGraph;
-
     /// Make sure the connected system forms a tree
     bool mIsTree;
 
     void setTreeRequirement(bool isTree) { mIsTree = isTree; }
 
-    Gecode::Symmetries identifySymmetries(Gecode::IntVarArray& connections);
-
+    /**
+     * Check whether the (fully assigned) links connect all agents
+     */
     bool isComplete() const;
 
+    /**
+     * Create the witness topology of a (fully assigned) solution
+     */
+    ConnectivityWitness toWitness() const;
+
+    /**
+     * Get the link variables which correspond to the links of a witness
+     * Agents of the witness are mapped to agents of the same model in order
+     * of appearance; links without correspondence are ignored
+     */
+    Gecode::IntVarArgs getLinks(const ConnectivityWitness& witness) const;
+
+    /**
+     * Construct the problem, where the search tries the links of the given
+     * witness first
+     */
+    Connectivity(const ModelPool& modelPool,
+            const OrganizationModelAsk& ask,
+            const owlapi::model::IRI& interfaceBaseClass,
+            const owlapi::model::IRI& property,
+            const ConnectivityWitness* warmStart);
+
+    /**
+     * Run the (restart-based) search for the given problem and update the
+     * statistics
+     * \param connectivity The problem, which will be deleted
+     * \param isComplete Set to true if the last evaluated solution is
+     * connected
+     * \return The last evaluated solution, which has to be deleted by the
+     * caller, or NULL if there is none
+     */
+    static Connectivity* search(Connectivity* connectivity, double timeoutInMs, size_t minFeasible, bool& isComplete);
+
+    /**
+     * Get the interfaces of a model, as defined by the max cardinality
+     * restrictions on the given property
+     */
+    static owlapi::model::IRIList getInterfaces(const owlapi::model::OWLOntologyAsk& ask,
+            const owlapi::model::IRI& model,
+            const owlapi::model::IRI& interfaceBaseClass,
+            const owlapi::model::IRI& property = vocabulary::OM::has());
+
     /**
      * Populate the
      * InterfaceIndexRange and InterfaceMapping to allow identification of
      * interfaces which belong to an atomic agent (model instance)
      */
     void identifyInterfaces();
-    void enforceSymmetricMatrix(Gecode::IntVarArray& connections);
-    void applyCompatibilityConstraints(Gecode::IntVarArray& connections);
-    void cacheExistingConnections(Gecode::IntVarArray& connections);
-    void maxOneLink(Gecode::IntVarArray& connections);
+
+    /**
+     * Identify all link candidates, i.e. pairs of compatible interfaces of
+     * different agents, and populate the index maps
+     */
+    void identifyLinks();
+
+    void enforceLinkCount();
+    void applyAgentConstraints();
+    void cacheExistingConnections();
+    void maxOneLink();
+    /**
+     * Post the connectivity propagator on the agent connections, so that
+     * disconnected (and for mIsTree cyclic) assignments are pruned during
+     * search
+     */
+    void enforceConnectivity();
+
+    /**
+     * Break the symmetry between agents of the same model by ordering them
+     * lexicographically by their number of connections and their links to
+     * agents of other models
+     */
+    void breakSymmetries();
 
 public:
 
@@ -142,6 +249,16 @@ public:
 
         std::string toString(size_t indent = 0) const;
 
+        /**
+         * Get the fields as vector
+         * \see getFieldDescription
+         */
+        std::vector<double> toVector() const;
+
+        /**
+         * Get a description of the fields, i.e. one entry per field
+         */
+        static std::string getFieldDescription();
 
         /**
          * Get a description of the field of the statistics vector
@@ -154,6 +271,13 @@ public:
          */
         static std::vector<numeric::Stats<double> > compute(const std::vector<Connectivity::Statistics>& stats);
 
+        /**
+         * Compute the quantile of each field, e.g. 0.5 for the median
+         * \param quantile Quantile in [0,1]
+         * \return quantile per field \see getFieldDescription
+         */
+        static std::vector<double> compute(const std::vector<Connectivity::Statistics>& stats, double quantile);
+
         static std::string toString(const std::vector<Connectivity::Statistics>& stats);
     };
 
@@ -174,6 +298,17 @@ public:
 
     static void setConfiguration(const qxcfg::Configuration& configuration) { msConfiguration = configuration; }
 
+    /**
+     * Set the seed of the random number generator, which is used for RND
+     * branching and the merit function, so that the search becomes
+     * reproducible
+     * \param seed The seed, or a negative value to use the seed from the
+     * configuration (connectivity/search/seed) or otherwise a hardware seed
+     */
+    static void setSeed(int64_t seed) { msSeed = seed; }
+
+    static int64_t getSeed() { return msSeed; }
+
     qxcfg::Configuration& getConfiguration() { return msConfiguration; }
 
     /**
@@ -209,6 +344,48 @@ public:
     static bool isFeasible(const ModelPool& modelPool, const OrganizationModelAsk& ask, graph_analysis::BaseGraph::Ptr& baseGraph, double timeoutInMs = 0, size_t minFeasible = 1,
             const owlapi::model::IRI& interfaceBaseClass = vocabulary::OM::resolve("ElectroMechanicalInterface") );
 
+    /**
+     * Check whether a model pool that differs from a base pool with known
+     * witness can be fully connected
+     *
+     * The witness of the base pool is repaired locally first: removed agents
+     * are taken out -- preferably leaves -- and the remaining parts are
+     * relinked via free compatible interfaces; added agents are attached to
+     * free compatible interfaces. Only if that fails, a search is performed,
+     * which tries the remaining links of the base witness first
+     * \param basePool The base model pool
+     * \param baseWitness A witness of the base model pool
+     * \param delta The change of agents, positive for added, negative for
+     * removed agents
+     * \param ask OrganizationModel to use for information about available
+     * interfaces etc.
+     * \param witness The witness of the resulting model pool if a connection
+     * is feasible
+     * \param timeoutInMs Timeout of the search, default is 0
+     * \param interfaceBaseClass The base type for the interfaces that have to
+     * be considered
+     * \return True if a connection is feasible, false otherwise
+     * \throw std::invalid_argument if the witness does not match the base
+     * pool or more agents are removed than available
+     */
+    static bool isFeasibleDelta(const ModelPool& basePool,
+            const ConnectivityWitness& baseWitness,
+            const ModelPoolDelta& delta,
+            const OrganizationModelAsk& ask,
+            ConnectivityWitness& witness,
+            double timeoutInMs = 0,
+            const owlapi::model::IRI& interfaceBaseClass = vocabulary::OM::resolve("ElectroMechanicalInterface") );
+
+private:
+    /**
+     * Perform the feasibility check, and create the connection graph of the
+     * accepted solution only if baseGraph is given
+     */
+    static bool checkFeasibility(const ModelPool& modelPool, const OrganizationModelAsk& ask, graph_analysis::BaseGraph::Ptr* baseGraph, double timeoutInMs, size_t minFeasible,
+            const owlapi::model::IRI& interfaceBaseClass);
+
+public:
+
     /**
      * Convert solution to string
      */
@@ -222,27 +399,39 @@ public:
     double computeMerit(Gecode::IntVar x, int idx) const;
 
     /**
-     * Return the number of evaluations for the last feasibility check
+     * Return the number of evaluations for the last feasibility check of
+     * the calling thread
      */
     static const Connectivity::Statistics& getStatistics() { return msStatistics; }
 
     /**
-     * Retrieve the connection graph of the last feasibility check
+     * Get the number of cached feasibility queries
+     */
+    static size_t getQueryCacheSize();
+
+    /**
+     * Retrieve the connection graph of the last feasibility check of the
+     * calling thread, which is only created when the check has been requested with a graph
      * \return connection graph
      */
     static const graph_analysis::BaseGraph::Ptr& getConnectionGraph() { return msConnectionGraph; }
 
     /**
-     * Reset / Clear the used query cache
+     * Reset / Clear the used query cache and the library of witness
+     * topologies
      */
-    static void resetQueryCache() { msQueryCache.clear(); }
+    static void resetQueryCache();
 
 protected:
-    static Connectivity::Statistics msStatistics;
-    static graph_analysis::BaseGraph::Ptr msConnectionGraph;
+    /// Statistics and connection graph of the last feasibility check of the
+    /// current thread, since checks might run in parallel
+    static thread_local Connectivity::Statistics msStatistics;
+    static thread_local graph_analysis::BaseGraph::Ptr msConnectionGraph;
 
     // General configuration to control, e.g. the branching behaviour
     static qxcfg::Configuration msConfiguration;
+    // Seed of the random number generator, negative for none \see setSeed
+    static int64_t msSeed;
 
     class NoConnectionInterfaces : public std::runtime_error
     {
@@ -252,7 +441,23 @@ protected:
             {}
     };
 
+    /// Guards msQueryCache, so that feasibility checks can run in parallel
+    static boost::shared_mutex msQueryCacheMutex;
     static QueryCache msQueryCache;
+
+    /// Guards msWitnessLibraries
+    static boost::mutex msWitnessLibrariesMutex;
+
+    /// Serializes the ontology queries of getInterfaces, since the reasoner
+    /// must not be queried concurrently by parallel feasibility checks
+    static boost::mutex msOntologyMutex;
+
+    /// Witness topologies of feasible model pools per ontology and interface
+    /// base class, which allow to answer queries for (larger) model pools
+    /// without search
+    /// Set "connectivity/witness-library" to false in the configuration to
+    /// disable the library
+    static std::map<std::pair<owlapi::model::IRI, owlapi::model::IRI>, ConnectivityWitnessLibrary> msWitnessLibraries;
 };
 
 
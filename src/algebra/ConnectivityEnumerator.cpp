@@ -0,0 +1,106 @@
+#include "ConnectivityEnumerator.hpp"
+#include <limits>
+#include <gecode/search.hh>
+
+namespace moreorg {
+namespace algebra {
+
+ConnectivityEnumerator::ConnectivityEnumerator(const ModelPool& modelPool,
+        const OrganizationModelAsk& ask,
+        const owlapi::model::IRI& interfaceBaseClass)
+    : mpStop(NULL)
+    , mpSearchEngine(NULL)
+    , mExhausted(false)
+    , mNumberOfTopologies(0)
+{
+    size_t numberOfInstances = modelPool.numberOfInstances();
+    if(numberOfInstances == 0)
+    {
+        throw std::invalid_argument("moreorg::algebra::ConnectivityEnumerator: "
+                " the given model pool has a model count of 0");
+    } else if(numberOfInstances == 1)
+    {
+        const owlapi::model::IRI& model = modelPool.compact().begin()->first;
+        mpSingleAgent = make_shared<ConnectivityWitness>();
+        mpSingleAgent->addAgent(model, Connectivity::getInterfaces(ask.ontology(), model, interfaceBaseClass));
+        return;
+    }
+
+    Connectivity* connectivity = NULL;
+    try {
+        connectivity = new Connectivity(modelPool, ask, interfaceBaseClass);
+    } catch(const Connectivity::NoConnectionInterfaces& e)
+    {
+        LOG_INFO_S << "No connection interfaces of type '" <<
+            interfaceBaseClass << "' found on " << modelPool.toString(4);
+        mExhausted = true;
+        return;
+    }
+
+    // The time limit is set for each call to next
+    mpStop = new Gecode::Search::TimeStop(std::numeric_limits<double>::max());
+
+    Gecode::Search::Options options;
+    options.stop = mpStop;
+    // A plain depth first search enumerates every solution exactly once
+    mpSearchEngine = new Gecode::DFS<Connectivity>(connectivity, options);
+    delete connectivity;
+}
+
+ConnectivityEnumerator::~ConnectivityEnumerator()
+{
+    delete mpSearchEngine;
+    delete mpStop;
+}
+
+bool ConnectivityEnumerator::next(ConnectivityWitness& witness, double budgetInMs)
+{
+    if(mExhausted)
+    {
+        return false;
+    }
+
+    if(mpSingleAgent)
+    {
+        witness = *mpSingleAgent;
+        mExhausted = true;
+        ++mNumberOfTopologies;
+        return true;
+    }
+
+    mpStop->limit(budgetInMs > 0 ? budgetInMs : std::numeric_limits<double>::max());
+    mpStop->reset();
+
+    Connectivity* current = NULL;
+    while((current = mpSearchEngine->next()))
+    {
+        // Connectivity is enforced during search, so that this check serves
+        // only as safeguard
+        if(current->isComplete())
+        {
+            witness = current->toWitness();
+            delete current;
+            ++mNumberOfTopologies;
+            return true;
+        }
+        delete current;
+    }
+
+    if(!mpSearchEngine->stopped())
+    {
+        mExhausted = true;
+    }
+    return false;
+}
+
+Gecode::Search::Statistics ConnectivityEnumerator::getStatistics() const
+{
+    if(mpSearchEngine)
+    {
+        return mpSearchEngine->statistics();
+    }
+    return Gecode::Search::Statistics();
+}
+
+} // end namespace algebra
+} // end namespace moreorg
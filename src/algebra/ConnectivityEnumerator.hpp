@@ -0,0 +1,93 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_ENUMERATOR_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_ENUMERATOR_HPP
+
+#include "Connectivity.hpp"
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class ConnectivityEnumerator
+ * \brief Enumerate the feasible (connected) topologies of a model pool one at
+ * a time
+ *
+ * The enumerator owns the search engine, so that the search resumes from its
+ * previous state with every call to next. Topologies are yielded in the order
+ * the search produces them. The symmetry breaking of Connectivity only orders
+ * agents of the same model by their number of connections and their links to
+ * agents of other models, so symmetric solutions are reduced, not
+ * eliminated: topologies which differ only by a permutation of agents of the
+ * same model might still be yielded more than once, e.g. for a pool of a
+ * single model
+ *
+ \verbatim
+ ConnectivityEnumerator enumerator(modelPool, ask);
+ ConnectivityWitness witness;
+ while(enumerator.next(witness, 1000))
+ {
+     graph_analysis::BaseGraph::Ptr graph = witness.toBaseGraph();
+     ...
+ }
+ if(!enumerator.isExhausted())
+ {
+     // budget expired -- call next again later to resume
+ }
+ \endverbatim
+ */
+class ConnectivityEnumerator
+{
+public:
+    typedef shared_ptr<ConnectivityEnumerator> Ptr;
+
+    /**
+     * Prepare the enumeration of topologies for a model pool
+     * \throw std::invalid_argument if the model pool is empty
+     */
+    ConnectivityEnumerator(const ModelPool& modelPool,
+            const OrganizationModelAsk& ask,
+            const owlapi::model::IRI& interfaceBaseClass = vocabulary::OM::resolve("ElectroMechanicalInterface"));
+
+    ~ConnectivityEnumerator();
+
+    /**
+     * Search for the next topology
+     * \param witness The next topology, if one has been found
+     * \param budgetInMs Time budget for this call, 0 for no limit
+     * \return True if a topology has been found, false if either the budget
+     * expired or all topologies have been enumerated \see isExhausted
+     */
+    bool next(ConnectivityWitness& witness, double budgetInMs = 0);
+
+    /**
+     * Check whether all topologies have been enumerated
+     */
+    bool isExhausted() const { return mExhausted; }
+
+    /**
+     * Get the number of topologies that have been yielded so far
+     */
+    size_t getNumberOfTopologies() const { return mNumberOfTopologies; }
+
+    /**
+     * Get the (accumulated) statistics of the underlying csp search
+     */
+    Gecode::Search::Statistics getStatistics() const;
+
+private:
+    // Non-copyable, since the enumerator owns the search engine
+    ConnectivityEnumerator(const ConnectivityEnumerator&);
+    ConnectivityEnumerator& operator=(const ConnectivityEnumerator&);
+
+    /// Yield the trivial topology of a single agent
+    shared_ptr<ConnectivityWitness> mpSingleAgent;
+
+    Gecode::Search::TimeStop* mpStop;
+    Gecode::DFS<Connectivity>* mpSearchEngine;
+
+    bool mExhausted;
+    size_t mNumberOfTopologies;
+};
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_ENUMERATOR_HPP
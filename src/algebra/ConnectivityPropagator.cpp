@@ -0,0 +1,266 @@
+#include "ConnectivityPropagator.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "../utils/UnionFind.hpp"
+
+namespace moreorg {
+namespace algebra {
+
+namespace {
+
+/**
+ * Depth-first search to identify bridges (Tarjan) on a graph in compressed
+ * adjacency representation
+ */
+struct BridgeSearch
+{
+    const int* offsets;
+    const int* adjacentAgent;
+    const int* adjacentLink;
+    int* discovery;
+    int* low;
+    bool* isBridge;
+    int time;
+
+    void visit(int agent, int parentLink)
+    {
+        discovery[agent] = low[agent] = time++;
+        for(int k = offsets[agent]; k < offsets[agent+1]; ++k)
+        {
+            int link = adjacentLink[k];
+            if(link == parentLink)
+            {
+                continue;
+            }
+
+            int other = adjacentAgent[k];
+            if(discovery[other] == -1)
+            {
+                visit(other, link);
+                low[agent] = std::min(low[agent], low[other]);
+                if(low[other] > discovery[agent])
+                {
+                    isBridge[link] = true;
+                }
+            } else {
+                low[agent] = std::min(low[agent], discovery[other]);
+            }
+        }
+    }
+};
+
+} // end anonymous namespace
+
+ConnectivityPropagator::ConnectivityPropagator(Gecode::Home home,
+        LinkViews& links,
+        const Gecode::IntSharedArray& endpoints,
+        int numberOfAgents,
+        bool isTree)
+    : Gecode::Propagator(home)
+    , mLinks(links)
+    , mEndpoints(endpoints)
+    , mNumberOfAgents(numberOfAgents)
+    , mIsTree(isTree)
+{
+    mLinks.subscribe(home, *this, Gecode::Int::PC_INT_BND);
+    home.notice(*this, Gecode::AP_DISPOSE);
+}
+
+ConnectivityPropagator::ConnectivityPropagator(Gecode::Space& home, ConnectivityPropagator& other)
+    : Gecode::Propagator(home, other)
+    , mEndpoints(other.mEndpoints)
+    , mNumberOfAgents(other.mNumberOfAgents)
+    , mIsTree(other.mIsTree)
+{
+    mLinks.update(home, other.mLinks);
+}
+
+Gecode::ExecStatus ConnectivityPropagator::post(Gecode::Home home,
+        LinkViews& links,
+        const Gecode::IntSharedArray& endpoints,
+        int numberOfAgents,
+        bool isTree)
+{
+    if(numberOfAgents <= 1)
+    {
+        return Gecode::ES_OK;
+    }
+    (void) new (home) ConnectivityPropagator(home, links, endpoints, numberOfAgents, isTree);
+    return Gecode::ES_OK;
+}
+
+Gecode::Propagator* ConnectivityPropagator::copy(Gecode::Space& home)
+{
+    return new (home) ConnectivityPropagator(home, *this);
+}
+
+size_t ConnectivityPropagator::dispose(Gecode::Space& home)
+{
+    home.ignore(*this, Gecode::AP_DISPOSE);
+    mLinks.cancel(home, *this, Gecode::Int::PC_INT_BND);
+    mEndpoints.~IntSharedArray();
+    (void) Gecode::Propagator::dispose(home);
+    return sizeof(*this);
+}
+
+Gecode::PropCost ConnectivityPropagator::cost(const Gecode::Space&, const Gecode::ModEventDelta&) const
+{
+    return Gecode::PropCost::quadratic(Gecode::PropCost::LO, mLinks.size());
+}
+
+void ConnectivityPropagator::reschedule(Gecode::Space& home)
+{
+    mLinks.reschedule(home, *this, Gecode::Int::PC_INT_BND);
+}
+
+Gecode::ExecStatus ConnectivityPropagator::establishBridges(Gecode::Space& home)
+{
+    Gecode::Region region;
+    int* offsets = region.alloc<int>(mNumberOfAgents + 1);
+    int* adjacentAgent = region.alloc<int>(2*mLinks.size());
+    int* adjacentLink = region.alloc<int>(2*mLinks.size());
+    int* discovery = region.alloc<int>(mNumberOfAgents);
+    int* low = region.alloc<int>(mNumberOfAgents);
+    bool* isBridge = region.alloc<bool>(mLinks.size());
+
+    // Compressed adjacency representation of the graph of possible links
+    std::fill(offsets, offsets + mNumberOfAgents + 1, 0);
+    for(int i = 0; i < mLinks.size(); ++i)
+    {
+        isBridge[i] = false;
+        if(mLinks[i].max() >= 1)
+        {
+            ++offsets[mEndpoints[2*i] + 1];
+            ++offsets[mEndpoints[2*i+1] + 1];
+        }
+    }
+    for(int a = 0; a < mNumberOfAgents; ++a)
+    {
+        offsets[a+1] += offsets[a];
+        discovery[a] = -1;
+    }
+    // use low as insertion position
+    std::copy(offsets, offsets + mNumberOfAgents, low);
+    for(int i = 0; i < mLinks.size(); ++i)
+    {
+        if(mLinks[i].max() >= 1)
+        {
+            int a0 = mEndpoints[2*i];
+            int a1 = mEndpoints[2*i+1];
+            adjacentAgent[low[a0]] = a1;
+            adjacentLink[low[a0]++] = i;
+            adjacentAgent[low[a1]] = a0;
+            adjacentLink[low[a1]++] = i;
+        }
+    }
+
+    BridgeSearch search = { offsets, adjacentAgent, adjacentLink,
+        discovery, low, isBridge, 0 };
+    search.visit(0, -1);
+
+    if(search.time != mNumberOfAgents)
+    {
+        // not all agents can be reached
+        return Gecode::ES_FAILED;
+    }
+
+    bool modified = false;
+    for(int i = 0; i < mLinks.size(); ++i)
+    {
+        if(isBridge[i] && mLinks[i].min() == 0)
+        {
+            if(Gecode::me_failed(mLinks[i].gq(home, 1)))
+            {
+                return Gecode::ES_FAILED;
+            }
+            modified = true;
+        }
+    }
+    return modified ? Gecode::ES_NOFIX : Gecode::ES_FIX;
+}
+
+Gecode::ExecStatus ConnectivityPropagator::removeCycleLinks(Gecode::Space& home)
+{
+    // Components of the established links
+    utils::UnionFind components(mNumberOfAgents);
+    for(int i = 0; i < mLinks.size(); ++i)
+    {
+        if(mLinks[i].min() >= 1)
+        {
+            if(!components.merge(mEndpoints[2*i], mEndpoints[2*i+1]))
+            {
+                return Gecode::ES_FAILED;
+            }
+        }
+    }
+
+    bool modified = false;
+    for(int i = 0; i < mLinks.size(); ++i)
+    {
+        if(!mLinks[i].assigned() && mLinks[i].min() == 0)
+        {
+            if(components.find(mEndpoints[2*i]) == components.find(mEndpoints[2*i+1]))
+            {
+                if(Gecode::me_failed(mLinks[i].eq(home, 0)))
+                {
+                    return Gecode::ES_FAILED;
+                }
+                modified = true;
+            }
+        }
+    }
+    return modified ? Gecode::ES_NOFIX : Gecode::ES_FIX;
+}
+
+Gecode::ExecStatus ConnectivityPropagator::propagate(Gecode::Space& home, const Gecode::ModEventDelta&)
+{
+    bool modified = false;
+    if(mIsTree)
+    {
+        Gecode::ExecStatus status = removeCycleLinks(home);
+        if(status == Gecode::ES_FAILED)
+        {
+            return Gecode::ES_FAILED;
+        }
+        modified = (status == Gecode::ES_NOFIX);
+    }
+
+    // Bridges cannot close a cycle, so that the tree property remains
+    // valid after establishing them
+    Gecode::ExecStatus status = establishBridges(home);
+    if(status == Gecode::ES_FAILED)
+    {
+        return Gecode::ES_FAILED;
+    }
+    modified = modified || (status == Gecode::ES_NOFIX);
+
+    if(mLinks.assigned())
+    {
+        return home.ES_SUBSUMED(*this);
+    }
+    return modified ? Gecode::ES_NOFIX : Gecode::ES_FIX;
+}
+
+void connected(Gecode::Home home,
+        const Gecode::IntVarArgs& links,
+        const Gecode::IntArgs& endpoints,
+        int numberOfAgents,
+        bool isTree)
+{
+    if(endpoints.size() != 2*links.size())
+    {
+        throw std::invalid_argument("moreorg::algebra::connected: expected two"
+                " endpoints per link");
+    }
+    if(home.failed())
+    {
+        return;
+    }
+
+    ConnectivityPropagator::LinkViews views(home, links);
+    Gecode::IntSharedArray sharedEndpoints(endpoints);
+    GECODE_ES_FAIL(ConnectivityPropagator::post(home, views, sharedEndpoints, numberOfAgents, isTree));
+}
+
+} // end namespace algebra
+} // end namespace moreorg
@@ -0,0 +1,102 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_PROPAGATOR_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_PROPAGATOR_HPP
+
+#include <gecode/int.hh>
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class ConnectivityPropagator
+ * \brief Propagator that enforces that a set of (agent-level) link variables
+ * forms a connected graph, and optionally a tree
+ *
+ * Each link variable corresponds to an undirected edge between two agents,
+ * where a value >= 1 means the link is established and 0 means it is not.
+ * The propagator
+ *  - fails when the graph of still possible links is disconnected,
+ *  - establishes every undecided link that is a bridge in the graph of
+ *    possible links, since it is required for connectivity,
+ *  - (tree only) fails when the established links contain a cycle and
+ *    removes every undecided link that would close a cycle
+ *
+ * This allows to prune disconnected assignments during search instead of
+ * enumerating and rejecting them after a solution has been found
+ */
+class ConnectivityPropagator : public Gecode::Propagator
+{
+public:
+    typedef Gecode::ViewArray<Gecode::Int::IntView> LinkViews;
+
+protected:
+    /// Link variables, one per edge
+    LinkViews mLinks;
+    /// Endpoints of the edges, i.e. for link i the agents at 2*i and 2*i+1
+    Gecode::IntSharedArray mEndpoints;
+    /// Number of agents (vertices)
+    int mNumberOfAgents;
+    /// Make sure that the established links form a tree
+    bool mIsTree;
+
+    ConnectivityPropagator(Gecode::Home home,
+            LinkViews& links,
+            const Gecode::IntSharedArray& endpoints,
+            int numberOfAgents,
+            bool isTree);
+
+    ConnectivityPropagator(Gecode::Space& home, ConnectivityPropagator& other);
+
+    /**
+     * Check that the graph of possible links is connected, then identify the
+     * undecided links that are bridges in this graph and establish them
+     * \return ES_FAILED if the graph of possible links is disconnected,
+     * ES_NOFIX if links have been established, ES_FIX otherwise
+     */
+    Gecode::ExecStatus establishBridges(Gecode::Space& home);
+
+    /**
+     * Remove all undecided links that would close a cycle of established
+     * links
+     * \return ES_FAILED if the established links already contain a cycle,
+     * ES_NOFIX if links have been removed, ES_FIX otherwise
+     */
+    Gecode::ExecStatus removeCycleLinks(Gecode::Space& home);
+
+public:
+    /**
+     * Post the propagator
+     */
+    static Gecode::ExecStatus post(Gecode::Home home,
+            LinkViews& links,
+            const Gecode::IntSharedArray& endpoints,
+            int numberOfAgents,
+            bool isTree);
+
+    virtual Gecode::Propagator* copy(Gecode::Space& home);
+
+    virtual size_t dispose(Gecode::Space& home);
+
+    virtual Gecode::PropCost cost(const Gecode::Space& home, const Gecode::ModEventDelta& med) const;
+
+    virtual void reschedule(Gecode::Space& home);
+
+    virtual Gecode::ExecStatus propagate(Gecode::Space& home, const Gecode::ModEventDelta& med);
+};
+
+/**
+ * Post constraint that the links form a connected graph over all agents
+ * \param links The link variables
+ * \param endpoints Agent indices for each link variable, i.e. link i connects
+ * agent endpoints[2*i] and endpoints[2*i+1]
+ * \param numberOfAgents Number of agents
+ * \param isTree Require the established links to form a tree
+ */
+void connected(Gecode::Home home,
+        const Gecode::IntVarArgs& links,
+        const Gecode::IntArgs& endpoints,
+        int numberOfAgents,
+        bool isTree);
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_PROPAGATOR_HPP
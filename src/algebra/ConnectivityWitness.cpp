@@ -0,0 +1,341 @@
+#include "ConnectivityWitness.hpp"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include "../Algebra.hpp"
+#include "../utils/UnionFind.hpp"
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace algebra {
+
+ConnectivityWitness::ConnectivityWitness()
+{}
+
+uint32_t ConnectivityWitness::addAgent(const IRI& model, const IRIList& interfaces)
+{
+    mModels.push_back(model);
+    mInterfaces.push_back(interfaces);
+    mUsedInterfaces.push_back(std::vector<bool>(interfaces.size(), false));
+    mModelPool[model] += 1;
+    return mModels.size() - 1;
+}
+
+void ConnectivityWitness::addLink(uint32_t agent0, uint32_t interface0, uint32_t agent1, uint32_t interface1)
+{
+    if(agent0 >= mModels.size() || agent1 >= mModels.size())
+    {
+        throw std::invalid_argument("moreorg::algebra::ConnectivityWitness::addLink: agent index out of range");
+    }
+    if(interface0 >= mInterfaces[agent0].size() || interface1 >= mInterfaces[agent1].size())
+    {
+        throw std::invalid_argument("moreorg::algebra::ConnectivityWitness::addLink: interface index out of range");
+    }
+
+    Link link = { agent0, interface0, agent1, interface1 };
+    mLinks.push_back(link);
+    mUsedInterfaces[agent0][interface0] = true;
+    mUsedInterfaces[agent1][interface1] = true;
+}
+
+bool ConnectivityWitness::extend(const ModelPool& delta,
+        const InterfaceCompatibility& compatibility,
+        const InterfaceProvider& interfaceProvider)
+{
+    typedef std::pair<IRI, IRIList> AgentSpec;
+    std::vector<AgentSpec> pending;
+    for(const ModelPool::value_type& v : delta)
+    {
+        if(v.second == 0)
+        {
+            continue;
+        }
+        IRIList interfaces = interfaceProvider(v.first);
+        pending.insert(pending.end(), v.second, AgentSpec(v.first, interfaces));
+    }
+
+    // Attach agents with many interfaces first, since they provide the most
+    // free interfaces for the remaining agents
+    std::stable_sort(pending.begin(), pending.end(),
+            [](const AgentSpec& a, const AgentSpec& b)
+            {
+                return a.second.size() > b.second.size();
+            });
+
+    bool progress = true;
+    while(!pending.empty() && progress)
+    {
+        progress = false;
+        std::vector<AgentSpec>::iterator pit = pending.begin();
+        while(pit != pending.end())
+        {
+            const IRIList& interfaces = pit->second;
+            bool attached = false;
+            for(uint32_t a = 0; a < mModels.size() && !attached; ++a)
+            {
+                for(uint32_t j = 0; j < mInterfaces[a].size() && !attached; ++j)
+                {
+                    const IRI& freeInterface = mInterfaces[a][j];
+                    if(mUsedInterfaces[a][j] || !compatibility.hasId(freeInterface))
+                    {
+                        continue;
+                    }
+                    size_t freeId = compatibility.getId(freeInterface);
+                    for(uint32_t k = 0; k < interfaces.size(); ++k)
+                    {
+                        if(compatibility.hasId(interfaces[k])
+                                && compatibility.isCompatible(freeId, compatibility.getId(interfaces[k])))
+                        {
+                            uint32_t agent = addAgent(pit->first, interfaces);
+                            addLink(a, j, agent, k);
+                            attached = true;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if(attached)
+            {
+                pit = pending.erase(pit);
+                progress = true;
+            } else {
+                ++pit;
+            }
+        }
+    }
+    return pending.empty();
+}
+
+bool ConnectivityWitness::reduce(const ModelPool& delta,
+        const InterfaceCompatibility& compatibility)
+{
+    for(const ModelPool::value_type& v : delta)
+    {
+        for(size_t n = 0; n < v.second; ++n)
+        {
+            std::vector< std::pair<size_t, uint32_t> > candidates;
+            for(uint32_t a = 0; a < mModels.size(); ++a)
+            {
+                if(mModels[a] == v.first)
+                {
+                    candidates.push_back(std::make_pair(getDegree(a), a));
+                }
+            }
+            std::sort(candidates.begin(), candidates.end());
+
+            bool removed = false;
+            for(const std::pair<size_t, uint32_t>& candidate : candidates)
+            {
+                ConnectivityWitness reduced = *this;
+                reduced.removeAgent(candidate.second);
+                if(reduced.connect(compatibility))
+                {
+                    *this = reduced;
+                    removed = true;
+                    break;
+                }
+            }
+            if(!removed)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void ConnectivityWitness::removeAgent(uint32_t agent)
+{
+    if(agent >= mModels.size())
+    {
+        throw std::invalid_argument("moreorg::algebra::ConnectivityWitness::removeAgent: agent index out of range");
+    }
+
+    std::vector<Link> links;
+    for(const Link& link : mLinks)
+    {
+        if(link.agent0 == agent)
+        {
+            mUsedInterfaces[link.agent1][link.interface1] = false;
+        } else if(link.agent1 == agent)
+        {
+            mUsedInterfaces[link.agent0][link.interface0] = false;
+        } else {
+            Link shifted = link;
+            shifted.agent0 -= link.agent0 > agent ? 1 : 0;
+            shifted.agent1 -= link.agent1 > agent ? 1 : 0;
+            links.push_back(shifted);
+        }
+    }
+    mLinks = links;
+
+    ModelPool::iterator mit = mModelPool.find(mModels[agent]);
+    if(--mit->second == 0)
+    {
+        mModelPool.erase(mit);
+    }
+    mModels.erase(mModels.begin() + agent);
+    mInterfaces.erase(mInterfaces.begin() + agent);
+    mUsedInterfaces.erase(mUsedInterfaces.begin() + agent);
+}
+
+bool ConnectivityWitness::connect(const InterfaceCompatibility& compatibility)
+{
+    utils::UnionFind components(mModels.size());
+    for(const Link& link : mLinks)
+    {
+        components.merge(link.agent0, link.agent1);
+    }
+
+    for(uint32_t a = 0; a < mModels.size() && components.getNumberOfSets() > 1; ++a)
+    {
+        for(uint32_t j = 0; j < mInterfaces[a].size(); ++j)
+        {
+            if(mUsedInterfaces[a][j] || !compatibility.hasId(mInterfaces[a][j]))
+            {
+                continue;
+            }
+            size_t id = compatibility.getId(mInterfaces[a][j]);
+            for(uint32_t b = a + 1; b < mModels.size() && !mUsedInterfaces[a][j]; ++b)
+            {
+                if(components.find(a) == components.find(b))
+                {
+                    continue;
+                }
+                for(uint32_t k = 0; k < mInterfaces[b].size(); ++k)
+                {
+                    if(!mUsedInterfaces[b][k]
+                            && compatibility.hasId(mInterfaces[b][k])
+                            && compatibility.isCompatible(id, compatibility.getId(mInterfaces[b][k])))
+                    {
+                        addLink(a, j, b, k);
+                        components.merge(a, b);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return components.getNumberOfSets() <= 1;
+}
+
+bool ConnectivityWitness::isConnected() const
+{
+    utils::UnionFind components(mModels.size());
+    for(const Link& link : mLinks)
+    {
+        components.merge(link.agent0, link.agent1);
+    }
+    return components.getNumberOfSets() <= 1;
+}
+
+size_t ConnectivityWitness::getDegree(uint32_t agent) const
+{
+    size_t degree = 0;
+    for(const Link& link : mLinks)
+    {
+        if(link.agent0 == agent || link.agent1 == agent)
+        {
+            ++degree;
+        }
+    }
+    return degree;
+}
+
+graph_analysis::BaseGraph::Ptr ConnectivityWitness::toBaseGraph() const
+{
+    using namespace graph_analysis;
+    Vertex::PtrList vertices;
+    // Currently testing connectivity is implemented only for lemon
+    BaseGraph::Ptr baseGraph = BaseGraph::getInstance(BaseGraph::LEMON_DIRECTED_GRAPH);
+    for(const IRI& model : mModels)
+    {
+        Vertex::Ptr v = make_shared<Vertex>(model.getFragment());
+        baseGraph->addVertex(v);
+        vertices.push_back(v);
+    }
+
+    for(const Link& link : mLinks)
+    {
+        Edge::Ptr e0 = make_shared<Edge>(vertices[link.agent0], vertices[link.agent1]);
+        e0->setLabel(mInterfaces[link.agent0][link.interface0].getFragment());
+        Edge::Ptr e1 = make_shared<Edge>(vertices[link.agent1], vertices[link.agent0]);
+        e1->setLabel(mInterfaces[link.agent1][link.interface1].getFragment());
+        baseGraph->addEdge(e0);
+        baseGraph->addEdge(e1);
+    }
+    return baseGraph;
+}
+
+std::string ConnectivityWitness::toString(size_t indent) const
+{
+    std::stringstream ss;
+    std::string hspace(indent,' ');
+    ss << hspace << "ConnectivityWitness:" << std::endl;
+    for(const Link& link : mLinks)
+    {
+        ss << hspace << "    " << mModels[link.agent0].getFragment() << "#" << link.agent0
+            << " (" << mInterfaces[link.agent0][link.interface0].getFragment() << ")"
+            << " -- "
+            << mModels[link.agent1].getFragment() << "#" << link.agent1
+            << " (" << mInterfaces[link.agent1][link.interface1].getFragment() << ")"
+            << std::endl;
+    }
+    return ss.str();
+}
+
+void ConnectivityWitnessLibrary::add(const ConnectivityWitness& witness)
+{
+    mWitnesses[witness.getModelPool()] = witness;
+}
+
+bool ConnectivityWitnessLibrary::find(const ModelPool& modelPool,
+        const InterfaceCompatibility& compatibility,
+        const ConnectivityWitness::InterfaceProvider& interfaceProvider,
+        ConnectivityWitness& witness) const
+{
+    ModelPool pool = modelPool.compact();
+    std::unordered_map<ModelPool, ConnectivityWitness>::const_iterator cit = mWitnesses.find(pool);
+    if(cit != mWitnesses.end())
+    {
+        witness = cit->second;
+        return true;
+    }
+
+    // Collect the witnesses of sub-pools, largest first
+    std::multimap<size_t, const ConnectivityWitness*, std::greater<size_t> > candidates;
+    for(const std::pair<const ModelPool, ConnectivityWitness>& entry : mWitnesses)
+    {
+        if(Algebra::isSubset(entry.first, pool))
+        {
+            candidates.insert(std::make_pair(entry.second.getNumberOfAgents(), &entry.second));
+        }
+    }
+
+    for(const std::pair<const size_t, const ConnectivityWitness*>& candidate : candidates)
+    {
+        ModelPool delta;
+        for(const ModelPool::value_type& v : pool)
+        {
+            size_t available = candidate.second->getModelPool().getValue(v.first, 0);
+            if(v.second > available)
+            {
+                delta[v.first] = v.second - available;
+            }
+        }
+
+        ConnectivityWitness extended = *candidate.second;
+        if(extended.extend(delta, compatibility, interfaceProvider))
+        {
+            witness = extended;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // end namespace algebra
+} // end namespace moreorg
@@ -0,0 +1,178 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_WITNESS_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_WITNESS_HPP
+
+#include <functional>
+#include <unordered_map>
+#include <graph_analysis/BaseGraph.hpp>
+#include "../ModelPool.hpp"
+#include "InterfaceCompatibility.hpp"
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class ConnectivityWitness
+ * \brief A witness topology which proves that a model pool can be connected
+ *
+ * The witness lists the agents (as model instances) together with their
+ * interfaces and the links between agents, where each link refers to the
+ * interfaces by their index in the interface list of the agent. The links
+ * form a spanning tree over all agents and every interface is used by at
+ * most one link
+ */
+class ConnectivityWitness
+{
+public:
+    /// Provide the list of interfaces of a model
+    typedef std::function<owlapi::model::IRIList(const owlapi::model::IRI&)> InterfaceProvider;
+
+    struct Link
+    {
+        /// Index of the first agent
+        uint32_t agent0;
+        /// Index of the interface in the interface list of the first agent
+        uint32_t interface0;
+        /// Index of the second agent
+        uint32_t agent1;
+        /// Index of the interface in the interface list of the second agent
+        uint32_t interface1;
+    };
+
+    ConnectivityWitness();
+
+    /**
+     * Add an agent
+     * \return index of the agent
+     */
+    uint32_t addAgent(const owlapi::model::IRI& model, const owlapi::model::IRIList& interfaces);
+
+    /**
+     * Add a link between two interfaces of the given agents
+     */
+    void addLink(uint32_t agent0, uint32_t interface0, uint32_t agent1, uint32_t interface1);
+
+    /**
+     * Attach additional agents to the free interfaces of this witness
+     *
+     * Agents are attached as leaves, so that the result remains a tree; an
+     * agent which cannot be attached yet is retried after the other agents
+     * have been attached
+     * \param delta The (additional) agents to attach
+     * \param compatibility The compatibility relation of interfaces
+     * \param interfaceProvider Provide the interfaces of a model
+     * \return True if all agents could be attached, false otherwise
+     */
+    bool extend(const ModelPool& delta,
+            const InterfaceCompatibility& compatibility,
+            const InterfaceProvider& interfaceProvider);
+
+    /**
+     * Remove agents, and reconnect the remaining agents where the removal
+     * splits the topology
+     *
+     * Agents of a model are removed in order of increasing number of links,
+     * so that leaves are removed first
+     * \param delta The agents to remove
+     * \param compatibility The compatibility relation of interfaces
+     * \return True if all agents could be removed and the remaining agents
+     * are connected, false otherwise
+     */
+    bool reduce(const ModelPool& delta,
+            const InterfaceCompatibility& compatibility);
+
+    /**
+     * Remove an agent and all its links
+     * Indices of the subsequent agents are shifted by one
+     */
+    void removeAgent(uint32_t agent);
+
+    /**
+     * Link the free compatible interfaces of agents which are not yet
+     * connected
+     * \return True if all agents are connected afterwards, false otherwise
+     */
+    bool connect(const InterfaceCompatibility& compatibility);
+
+    /**
+     * Check whether the links connect all agents
+     */
+    bool isConnected() const;
+
+    /**
+     * Get the number of links of an agent
+     */
+    size_t getDegree(uint32_t agent) const;
+
+    const owlapi::model::IRI& getModel(uint32_t agent) const { return mModels.at(agent); }
+
+    const owlapi::model::IRIList& getInterfaces(uint32_t agent) const { return mInterfaces.at(agent); }
+
+    /**
+     * Get the (compact) model pool this witness is valid for
+     */
+    const ModelPool& getModelPool() const { return mModelPool; }
+
+    size_t getNumberOfAgents() const { return mModels.size(); }
+
+    const std::vector<Link>& getLinks() const { return mLinks; }
+
+    /**
+     * Create the connection graph of this witness, with one vertex per agent
+     * and two directed edges per link, labelled with the interface of the
+     * source agent
+     */
+    graph_analysis::BaseGraph::Ptr toBaseGraph() const;
+
+    std::string toString(size_t indent = 0) const;
+
+private:
+    ModelPool mModelPool;
+    /// Model per agent
+    owlapi::model::IRIList mModels;
+    /// Interfaces per agent
+    std::vector<owlapi::model::IRIList> mInterfaces;
+    /// Mark the interfaces (per agent) which are used by a link
+    std::vector< std::vector<bool> > mUsedInterfaces;
+    std::vector<Link> mLinks;
+};
+
+/**
+ * \class ConnectivityWitnessLibrary
+ * \brief Library of witness topologies indexed by (compact) model pool
+ *
+ * Feasibility of a connection depends only on the number of agents per
+ * model, so that a witness can be reused for the same model pool and
+ * extended for a larger model pool
+ */
+class ConnectivityWitnessLibrary
+{
+public:
+    /**
+     * Add a witness, replacing any existing witness for the same model pool
+     */
+    void add(const ConnectivityWitness& witness);
+
+    /**
+     * Find a witness for the given model pool: either a stored one or one
+     * derived from a stored witness of a sub-pool by attaching the
+     * additional agents
+     * Sub-pools are tried in order of decreasing size
+     * \param witness The resulting witness
+     * \return True if a witness has been found, false otherwise
+     */
+    bool find(const ModelPool& modelPool,
+            const InterfaceCompatibility& compatibility,
+            const ConnectivityWitness::InterfaceProvider& interfaceProvider,
+            ConnectivityWitness& witness) const;
+
+    size_t size() const { return mWitnesses.size(); }
+
+    void clear() { mWitnesses.clear(); }
+
+private:
+    std::unordered_map<ModelPool, ConnectivityWitness> mWitnesses;
+};
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_CONNECTIVITY_WITNESS_HPP
@@ -0,0 +1,117 @@
+#include "InterfaceCompatibility.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <base-logging/Logging.hpp>
+#include "../vocabularies/OM.hpp"
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace algebra {
+
+const size_t InterfaceCompatibility::UNKNOWN_ID = std::numeric_limits<size_t>::max();
+
+InterfaceCompatibility::InterfaceCompatibility(const owlapi::model::OWLOntologyAsk& ask,
+        const owlapi::model::IRI& interfaceBaseClass)
+    : mInterfaceBaseClass(interfaceBaseClass)
+{
+    mInterfaceModels.push_back(interfaceBaseClass);
+    IRIList subclasses = ask.allSubClassesOf(interfaceBaseClass);
+    for(const IRI& subclass : subclasses)
+    {
+        if(subclass != interfaceBaseClass)
+        {
+            mInterfaceModels.push_back(subclass);
+        }
+    }
+
+    for(size_t id = 0; id < mInterfaceModels.size(); ++id)
+    {
+        mInterfaceIds[ mInterfaceModels[id] ] = id;
+    }
+
+    size_t numberOfModels = mInterfaceModels.size();
+    mCompatibility.resize(numberOfModels*numberOfModels, 0);
+    for(size_t id0 = 0; id0 < numberOfModels; ++id0)
+    {
+        for(size_t id1 = 0; id1 < numberOfModels; ++id1)
+        {
+            const IRI& interfaceModel0 = mInterfaceModels[id0];
+            const IRI& interfaceModel1 = mInterfaceModels[id1];
+            try {
+                mCompatibility[id0*numberOfModels + id1] = ask.isRelatedTo(interfaceModel0,
+                        vocabulary::OM::compatibleWith(),
+                        interfaceModel1);
+            } catch(const std::invalid_argument& e)
+            {
+                LOG_DEBUG_S << "No relation found between " <<
+                    interfaceModel0 << " and " << interfaceModel1 <<
+                    " -- " << e.what();
+                // seems there is not even an individual for this
+                // interface type
+            }
+        }
+    }
+}
+
+size_t InterfaceCompatibility::getId(const owlapi::model::IRI& interfaceModel) const
+{
+    std::map<IRI, size_t>::const_iterator cit = mInterfaceIds.find(interfaceModel);
+    if(cit == mInterfaceIds.end())
+    {
+        throw std::invalid_argument("moreorg::algebra::InterfaceCompatibility::getId:"
+                " '" + interfaceModel.toString() + "' is not a known interface of type '"
+                + mInterfaceBaseClass.toString() + "'");
+    }
+    return cit->second;
+}
+
+size_t InterfaceCompatibility::findId(const owlapi::model::IRI& interfaceModel) const
+{
+    std::map<IRI, size_t>::const_iterator cit = mInterfaceIds.find(interfaceModel);
+    if(cit == mInterfaceIds.end())
+    {
+        return UNKNOWN_ID;
+    }
+    return cit->second;
+}
+
+bool InterfaceCompatibility::isCompatible(const owlapi::model::IRI& interfaceModel0,
+        const owlapi::model::IRI& interfaceModel1) const
+{
+    return isCompatible(getId(interfaceModel0), getId(interfaceModel1));
+}
+
+std::vector<size_t> InterfaceCompatibility::getCompatibleIds(size_t id) const
+{
+    std::vector<size_t> ids;
+    for(size_t other = 0; other < mInterfaceModels.size(); ++other)
+    {
+        if(isCompatible(id, other))
+        {
+            ids.push_back(other);
+        }
+    }
+    return ids;
+}
+
+std::string InterfaceCompatibility::toString(uint32_t indent) const
+{
+    std::stringstream ss;
+    std::string hspace(indent,' ');
+    ss << hspace << "InterfaceCompatibility: " << mInterfaceBaseClass.toString() << std::endl;
+    for(size_t id = 0; id < mInterfaceModels.size(); ++id)
+    {
+        ss << hspace << "    " << mInterfaceModels[id].getFragment() << " --> ";
+        for(size_t other : getCompatibleIds(id))
+        {
+            ss << mInterfaceModels[other].getFragment() << " ";
+        }
+        ss << std::endl;
+    }
+    return ss.str();
+}
+
+} // end namespace algebra
+} // end namespace moreorg
@@ -0,0 +1,127 @@
+#ifndef ORGANIZATION_MODEL_ALGEBRA_INTERFACE_COMPATIBILITY_HPP
+#define ORGANIZATION_MODEL_ALGEBRA_INTERFACE_COMPATIBILITY_HPP
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <owlapi/model/IRI.hpp>
+#include <owlapi/model/OWLOntologyAsk.hpp>
+#include "../SharedPtr.hpp"
+
+namespace moreorg {
+namespace algebra {
+
+/**
+ * \class InterfaceCompatibility
+ * \brief Precomputed compatibility relation between all interface classes of
+ * an organization model
+ *
+ * \details
+ * Interface classes, i.e. the given base class and all its subclasses, are
+ * interned, i.e. each class is mapped to a consecutive id. The
+ * compatibility is stored as a dense matrix over these ids, where
+ * isCompatible(a,b) corresponds to the ontology query
+ * 'a compatibleWith b'.
+ *
+ * The relation depends only on the ontology, so that a single instance can be
+ * shared by all queries on the same organization model
+ * \see OrganizationModelAsk::getInterfaceCompatibility
+ */
+class InterfaceCompatibility
+{
+public:
+    typedef shared_ptr<const InterfaceCompatibility> Ptr;
+
+    /// Id of interface classes which are not part of the interface
+    /// hierarchy, such an interface is compatible with no other interface
+    static const size_t UNKNOWN_ID;
+
+    /**
+     * Compute the compatibility relation between all subclasses of the
+     * interface base class
+     * \param ask Ontology to query
+     * \param interfaceBaseClass Base class of the interfaces
+     */
+    InterfaceCompatibility(const owlapi::model::OWLOntologyAsk& ask,
+            const owlapi::model::IRI& interfaceBaseClass);
+
+    /**
+     * Get the base class of the interfaces
+     */
+    const owlapi::model::IRI& getInterfaceBaseClass() const { return mInterfaceBaseClass; }
+
+    /**
+     * Get the interned interface classes, where the position in the list
+     * corresponds to the id of the class
+     */
+    const owlapi::model::IRIList& getInterfaceModels() const { return mInterfaceModels; }
+
+    /**
+     * Get the number of interned interface classes
+     */
+    size_t size() const { return mInterfaceModels.size(); }
+
+    /**
+     * Get the id of an interface class
+     * \throw std::invalid_argument if the class is not a known interface
+     * class
+     */
+    size_t getId(const owlapi::model::IRI& interfaceModel) const;
+
+    /**
+     * Get the id of an interface class
+     * \return the id, or UNKNOWN_ID if the class is not a known interface
+     * class
+     */
+    size_t findId(const owlapi::model::IRI& interfaceModel) const;
+
+    /**
+     * Check if an interface class is known
+     */
+    bool hasId(const owlapi::model::IRI& interfaceModel) const { return mInterfaceIds.count(interfaceModel); }
+
+    /**
+     * Check if two interface classes (by id) are compatible
+     * \return false if one of the ids is UNKNOWN_ID
+     */
+    bool isCompatible(size_t id0, size_t id1) const
+    {
+        if(id0 >= mInterfaceModels.size() || id1 >= mInterfaceModels.size())
+        {
+            return false;
+        }
+        return mCompatibility[id0*mInterfaceModels.size() + id1];
+    }
+
+    /**
+     * Check if two interface classes are compatible
+     * \throw std::invalid_argument if one of the classes is not a known interface
+     * class
+     */
+    bool isCompatible(const owlapi::model::IRI& interfaceModel0,
+            const owlapi::model::IRI& interfaceModel1) const;
+
+    /**
+     * Get the ids of all interface classes that are compatible with the
+     * given one
+     */
+    std::vector<size_t> getCompatibleIds(size_t id) const;
+
+    /**
+     * Stringify object
+     * \param indent Indentation in number of spaces
+     * \return stringified object
+     */
+    std::string toString(uint32_t indent = 0) const;
+
+private:
+    owlapi::model::IRI mInterfaceBaseClass;
+    owlapi::model::IRIList mInterfaceModels;
+    std::map<owlapi::model::IRI, size_t> mInterfaceIds;
+    /// Row-major compatibility matrix
+    std::vector<uint8_t> mCompatibility;
+};
+
+} // end namespace algebra
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_ALGEBRA_INTERFACE_COMPATIBILITY_HPP
@@ -1,12 +1,19 @@
 #ifndef ORGANIZATION_MODEL_CCF_CCF_HPP
 #define ORGANIZATION_MODEL_CCF_CCF_HPP
 
-#include <set>
+#include <cassert>
+#include <iterator>
+#include <utility>
 #include <vector>
 #include <algorithm>
 #include <sstream>
+#include <atomic>
 #include <stdint.h>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
 #include <base-logging/Logging.hpp>
+#include "../SharedPtr.hpp"
+#include "../utils/WorkStealingQueue.hpp"
 
 /**
  * This is an implementation of the Constrained Coalition Formation algorithm
@@ -16,15 +23,22 @@
 namespace moreorg
 {
 
+/**
+ * Set of items, which is stored as sorted vector
+ *
+ * Compared to std::set this requires a single allocation per set, and
+ * copying, union and subset tests are linear scans
+ */
 template<typename T>
 class Set
 {
 protected:
-    std::set<T> mSet;
+    std::vector<T> mSet;
 
 public:
-    typedef typename std::set<T>::const_iterator const_iterator;
-    typedef typename std::set<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    /// Items cannot be modified in place, since that might break the order
+    typedef const_iterator iterator;
 
     Set()
     {}
@@ -42,16 +56,7 @@ public:
         {
             return false;
         }
-
-        for(const T& item : other)
-        {
-            if(!mSet.count(item) )
-            {
-                return false;
-            }
-        }
-
-        return true;
+        return includes(other);
     }
 
     bool includes(const Set<T>& other) const
@@ -61,37 +66,56 @@ public:
 
     Set<T> createUnion(const Set<T>& s) const
     {
-        Set<T> tmpSet = *this;
-        for(const T& item : s)
-        {
-            tmpSet.insert(item);
-        }
+        Set<T> tmpSet;
+        tmpSet.mSet.reserve(mSet.size() + s.mSet.size());
+        std::set_union(mSet.begin(), mSet.end(), s.mSet.begin(), s.mSet.end(),
+                std::back_inserter(tmpSet.mSet));
         return tmpSet;
     }
 
     Set<T> without(const T& item) const
     {
-        Set<T> tmpSet = *this;
-        tmpSet.mSet.erase(item);
+        Set<T> tmpSet;
+        tmpSet.mSet.reserve(mSet.size());
+        for(const T& t : mSet)
+        {
+            if(t < item || item < t)
+            {
+                tmpSet.mSet.push_back(t);
+            }
+        }
         return tmpSet;
     }
 
     const_iterator begin() const { return mSet.begin(); }
     const_iterator end() const { return mSet.end(); }
 
-    iterator begin() { return mSet.begin(); }
-    iterator end() { return mSet.end(); }
-
     bool empty() const { return mSet.empty(); }
     size_t size() const { return mSet.size(); }
 
     bool insert(const T& item)
     {
-        std::pair< typename std::set<T>::iterator, bool> it = mSet.insert(item);
-        return it.second;
+        typename std::vector<T>::iterator it = std::lower_bound(mSet.begin(), mSet.end(), item);
+        if(it != mSet.end() && !(item < *it))
+        {
+            return false;
+        }
+        mSet.insert(it, item);
+        return true;
     }
 
-    const T& first() const { assert(!empty()); return *mSet.begin(); }
+    bool erase(const T& item)
+    {
+        typename std::vector<T>::iterator it = std::lower_bound(mSet.begin(), mSet.end(), item);
+        if(it == mSet.end() || item < *it)
+        {
+            return false;
+        }
+        mSet.erase(it);
+        return true;
+    }
+
+    const T& first() const { assert(!empty()); return mSet.front(); }
     void clear() { mSet.clear(); }
 
     bool operator<( const Set<T>& other) const
@@ -99,7 +123,7 @@ public:
         return mSet < other.mSet;
     }
 
-    bool contains(const T& item) const { return mSet.count(item); }
+    bool contains(const T& item) const { return std::binary_search(mSet.begin(), mSet.end(), item); }
 
     std::string toString() const
     {
@@ -119,51 +143,227 @@ public:
     }
 };
 
-template<typename T>
-class SetOfSets : public Set< Set<T> >
+/**
+ * Set of atoms of a small universe, i.e. the atoms are indices in
+ * the range of [0,255], which is stored as bitset
+ *
+ * Use this specialization for CCF by numbering the atoms, e.g. CCF<uint8_t>
+ */
+template<>
+class Set<uint8_t>
 {
+protected:
+    enum { NUMBER_OF_WORDS = 4 };
+    uint64_t mWords[NUMBER_OF_WORDS];
 
-public:
-    SetOfSets() {}
+    static size_t word(uint8_t item) { return item >> 6; }
+    static uint64_t bit(uint8_t item) { return uint64_t(1) << (item & 63); }
 
-    SetOfSets(const Set<T>& initial)
+    /**
+     * Get the index of the first item starting from the given index,
+     * 256 if there is none
+     */
+    size_t next(size_t index) const
     {
-        this->insert( initial );
-        assert( Set< Set<T> >::size() == 1 );
+        for(size_t w = index >> 6; w < NUMBER_OF_WORDS; ++w)
+        {
+            uint64_t bits = mWords[w];
+            if(w == (index >> 6))
+            {
+                bits &= ~uint64_t(0) << (index & 63);
+            }
+            if(bits)
+            {
+                return (w << 6) + __builtin_ctzll(bits);
+            }
+        }
+        return NUMBER_OF_WORDS*64;
     }
 
-    bool containsEmptySet() const
+public:
+    class const_iterator
     {
-        if(Set< Set<T> >::mSet.empty())
+        const Set<uint8_t>* mSet;
+        size_t mIndex;
+        uint8_t mItem;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef uint8_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const uint8_t* pointer;
+        typedef const uint8_t& reference;
+
+        const_iterator(const Set<uint8_t>* set, size_t index)
+            : mSet(set)
+            , mIndex(index)
+            , mItem(index)
+        {}
+
+        const uint8_t& operator*() const { return mItem; }
+        const_iterator& operator++()
         {
-            return false;
+            mIndex = mSet->next(mIndex + 1);
+            mItem = mIndex;
+            return *this;
         }
+        const_iterator operator++(int) { const_iterator it = *this; ++(*this); return it; }
+        bool operator==(const const_iterator& other) const { return mIndex == other.mIndex; }
+        bool operator!=(const const_iterator& other) const { return mIndex != other.mIndex; }
+    };
+    typedef const_iterator iterator;
 
-        for(const Set<T>& s : Set< Set<T> >::mSet)
+    Set()
+    {
+        clear();
+    }
+
+    Set(uint8_t initial)
+    {
+        clear();
+        insert(initial);
+    }
+
+    bool isSupersetOf(const Set<uint8_t>& other) const
+    {
+        return other.size() < size() && includes(other);
+    }
+
+    bool includes(const Set<uint8_t>& other) const
+    {
+        for(size_t w = 0; w < NUMBER_OF_WORDS; ++w)
         {
-            if(s.empty())
+            if(other.mWords[w] & ~mWords[w])
             {
-                return true;
+                return false;
             }
         }
+        return true;
+    }
+
+    Set<uint8_t> createUnion(const Set<uint8_t>& s) const
+    {
+        Set<uint8_t> tmpSet;
+        for(size_t w = 0; w < NUMBER_OF_WORDS; ++w)
+        {
+            tmpSet.mWords[w] = mWords[w] | s.mWords[w];
+        }
+        return tmpSet;
+    }
+
+    Set<uint8_t> without(uint8_t item) const
+    {
+        Set<uint8_t> tmpSet = *this;
+        tmpSet.erase(item);
+        return tmpSet;
+    }
+
+    const_iterator begin() const { return const_iterator(this, next(0)); }
+    const_iterator end() const { return const_iterator(this, NUMBER_OF_WORDS*64); }
+
+    bool empty() const
+    {
+        return !(mWords[0] | mWords[1] | mWords[2] | mWords[3]);
+    }
+
+    size_t size() const
+    {
+        size_t count = 0;
+        for(size_t w = 0; w < NUMBER_OF_WORDS; ++w)
+        {
+            count += __builtin_popcountll(mWords[w]);
+        }
+        return count;
+    }
 
+    bool insert(uint8_t item)
+    {
+        bool inserted = !contains(item);
+        mWords[word(item)] |= bit(item);
+        return inserted;
+    }
+
+    bool erase(uint8_t item)
+    {
+        bool erased = contains(item);
+        mWords[word(item)] &= ~bit(item);
+        return erased;
+    }
+
+    uint8_t first() const { assert(!empty()); return next(0); }
+    void clear() { std::fill(mWords, mWords + NUMBER_OF_WORDS, 0); }
+
+    /**
+     * Lexicographical order of the sorted items, as for the generic Set
+     */
+    bool operator<( const Set<uint8_t>& other) const
+    {
+        for(size_t w = 0; w < NUMBER_OF_WORDS; ++w)
+        {
+            uint64_t difference = mWords[w] ^ other.mWords[w];
+            if(difference)
+            {
+                // the lowest item that is only in one of the sets
+                uint8_t item = (w << 6) + __builtin_ctzll(difference);
+                if(contains(item))
+                {
+                    // this set is smaller unless other has no further items
+                    return other.next(item) != NUMBER_OF_WORDS*64;
+                }
+                return next(item) == NUMBER_OF_WORDS*64;
+            }
+        }
         return false;
     }
 
+    bool contains(uint8_t item) const { return mWords[word(item)] & bit(item); }
+
+    std::string toString() const
+    {
+        std::stringstream ss;
+        ss << "{";
+        for(const_iterator it = begin(); it != end(); ++it)
+        {
+            if(it != begin())
+            {
+                ss << ",";
+            }
+            ss << static_cast<unsigned>(*it);
+        }
+        return ss.str() + "}";
+    }
+};
+
+template<typename T>
+class SetOfSets : public Set< Set<T> >
+{
+
+public:
+    SetOfSets() {}
+
+    SetOfSets(const Set<T>& initial)
+    {
+        this->insert( initial );
+        assert( Set< Set<T> >::size() == 1 );
+    }
+
+    bool containsEmptySet() const
+    {
+        // the empty set is the smallest of all sets
+        return !this->empty() && this->first().empty();
+    }
+
     SetOfSets<T> without(const Set<T>& item) const
     {
         SetOfSets<T> tmpSet = *this;
-        tmpSet.mSet.erase(item);
+        tmpSet.erase(item);
         return tmpSet;
     }
 
     SetOfSets<T> createUnion(const SetOfSets<T>& other) const
     {
-        SetOfSets<T> tmpSet = *this;
-        for(const Set<T> item : other)
-        {
-            tmpSet.insert(item);
-        }
+        SetOfSets<T> tmpSet;
+        static_cast< Set< Set<T> >& >(tmpSet) = Set< Set<T> >::createUnion(other);
         return tmpSet;
     }
 
@@ -177,12 +377,9 @@ public:
     Set<T> flatten() const
     {
         Set<T> newSet;
-        for(const Set<T>& s : Set< Set<T> >::mSet)
+        for(const Set<T>& s : *this)
         {
-            for(const T& t : s)
-            {
-                newSet.insert(t);
-            }
+            newSet = newSet.createUnion(s);
         }
         return newSet;
     }
@@ -190,7 +387,7 @@ public:
     bool includes(const SetOfSets<T>& other) const
     {
         bool includes = false;
-        for(const Set<T>& thisSubset : Set< Set<T> >::mSet)
+        for(const Set<T>& thisSubset : *this)
         {
             for(const Set<T>& otherSubset : other)
             {
@@ -208,18 +405,44 @@ public:
         return includes;
     }
 
+    /**
+     * Remove all sets which are a superset of another set
+     */
+    void removeSupersets()
+    {
+        SetOfSets<T> minimalSets;
+        for(const Set<T>& s : *this)
+        {
+            bool isSuperset = false;
+            for(const Set<T>& other : *this)
+            {
+                if(s.isSupersetOf(other))
+                {
+                    isSuperset = true;
+                    break;
+                }
+            }
+            if(!isSuperset)
+            {
+                // sets are visited in order, so that appending keeps the order
+                minimalSets.mSet.push_back(s);
+            }
+        }
+        this->mSet.swap(minimalSets.mSet);
+    }
+
     std::string toString() const
     {
         std::stringstream ss;
         ss << "{";
-        for(const Set<T>& s : Set< Set<T> >::mSet)
+        for(const Set<T>& s : *this)
         {
             ss << s.toString();
             ss << ",";
         }
 
         std::string s = ss.str();
-        if(!Set< Set<T> >::mSet.empty())
+        if(!this->empty())
         {
             s = s.substr(0, s.size()-1);
         }
@@ -227,7 +450,6 @@ public:
     }
 };
 
-
 template<typename T>
 struct Coalition
 {
@@ -243,7 +465,7 @@ struct Coalition
     Coalition()
     {}
 
-    Coalition(Constraints positive, Constraints negative)
+    Coalition(const Constraints& positive, const Constraints& negative)
         : positive(positive)
         , negative(negative)
     {}
@@ -267,11 +489,11 @@ struct Coalition
         if(positive < other.positive)
         {
             return true;
-        } else if(negative < other.negative)
+        } else if(other.positive < positive)
         {
-            return true;
+            return false;
         }
-        return false;
+        return negative < other.negative;
     }
 
     bool constraintsApply(const Constraints& constraints) const
@@ -299,7 +521,7 @@ struct Coalition
         return coalitions;
     }
 
-    static Set<T> getUniqueElements(Coalitions& coalitions)
+    static Set<T> getUniqueElements(const Coalitions& coalitions)
     {
         Set<T> atoms;
         for(const Coalition& coalition : coalitions)
@@ -352,10 +574,108 @@ private:
     Constraints mPositiveConstraints;
     Constraints mNegativeConstraints;
     uint32_t mMaximumCoalitionSize;
+    size_t mNumberOfThreads;
+    size_t mParallelCutoff;
+
+    /**
+     * Results of an exploration task, i.e. of a subtree of the search
+     *
+     * The results of subtrees that have been forked to another task are
+     * merged at the position where the serial exploration would have added
+     * them, so that the merged result is identical to the serial one
+     */
+    struct TaskResult
+    {
+        typedef shared_ptr<TaskResult> Ptr;
+
+        struct Fork
+        {
+            size_t aStarPosition;
+            size_t coalitionStructuresPosition;
+            Ptr result;
+        };
+
+        Coalitions coalitions;
+        AStar aStar;
+        std::vector<Coalitions> coalitionStructures;
+        std::vector<Fork> forks;
+
+        void mergeInto(Coalitions& allCoalitions, AStar& allAStar, std::vector<Coalitions>& allCoalitionStructures) const
+        {
+            for(const Coalition& coalition : coalitions)
+            {
+                allCoalitions.insert(coalition);
+            }
+
+            size_t aStarPosition = 0;
+            size_t coalitionStructuresPosition = 0;
+            for(const Fork& fork : forks)
+            {
+                allAStar.insert(allAStar.end(), aStar.begin() + aStarPosition, aStar.begin() + fork.aStarPosition);
+                allCoalitionStructures.insert(allCoalitionStructures.end(),
+                        coalitionStructures.begin() + coalitionStructuresPosition,
+                        coalitionStructures.begin() + fork.coalitionStructuresPosition);
+                aStarPosition = fork.aStarPosition;
+                coalitionStructuresPosition = fork.coalitionStructuresPosition;
+
+                fork.result->mergeInto(allCoalitions, allAStar, allCoalitionStructures);
+            }
+            allAStar.insert(allAStar.end(), aStar.begin() + aStarPosition, aStar.end());
+            allCoalitionStructures.insert(allCoalitionStructures.end(),
+                    coalitionStructures.begin() + coalitionStructuresPosition,
+                    coalitionStructures.end());
+        }
+    };
+
+    typedef boost::function<void (size_t)> Task;
+
+    /**
+     * Shared state of the workers of a parallel exploration
+     */
+    struct Exploration
+    {
+        Exploration(size_t numberOfWorkers)
+            : queues(numberOfWorkers)
+            , pendingTasks(0)
+        {}
+
+        bool take(size_t worker, Task& task)
+        {
+            if(queues[worker].pop(task))
+            {
+                return true;
+            }
+            for(size_t i = 1; i < queues.size(); ++i)
+            {
+                if(queues[(worker + i) % queues.size()].steal(task))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector< utils::WorkStealingQueue<Task> > queues;
+        /// Number of tasks which have been added, but not yet completed
+        std::atomic<size_t> pendingTasks;
+    };
+
+    /**
+     * Context of the task that explores a subtree
+     */
+    struct Context
+    {
+        /// The parallel exploration, NULL when exploring serially
+        Exploration* exploration;
+        size_t worker;
+        TaskResult* result;
+    };
 
 public:
 
     CCF(const AtomsVector& atoms)
+        : mNumberOfThreads(1)
+        , mParallelCutoff(8)
     {
         for(const Atom& atom : atoms)
         {
@@ -367,12 +687,37 @@ public:
 
     CCF(const Atoms& atoms)
         : mAtoms(atoms)
+        , mNumberOfThreads(1)
+        , mParallelCutoff(8)
     {
         mMaximumCoalitionSize = mAtoms.size();
     }
 
     void setMaximumCoalitionSize(uint32_t size) { mMaximumCoalitionSize = size; }
 
+    /**
+     * Set the number of threads to explore the search tree with
+     * \param numberOfThreads 1 for a serial exploration (default), 0 to
+     * use one thread per core
+     */
+    void setNumberOfThreads(size_t numberOfThreads)
+    {
+        if(numberOfThreads == 0)
+        {
+            numberOfThreads = std::max(1u, boost::thread::hardware_concurrency());
+        }
+        mNumberOfThreads = numberOfThreads;
+    }
+    size_t getNumberOfThreads() const { return mNumberOfThreads; }
+
+    /**
+     * Set the minimum number of remaining atoms a subtree must have to be
+     * explored as a separate task, smaller subtrees are explored by the
+     * task that reaches them
+     */
+    void setParallelCutoff(size_t numberOfAtoms) { mParallelCutoff = numberOfAtoms; }
+    size_t getParallelCutoff() const { return mParallelCutoff; }
+
     bool addNegativeConstraint(const Constraint& c) { return mNegativeConstraints.insert(c); }
     bool addPositiveConstraint(const Constraint& c) { return mPositiveConstraints.insert(c); }
 
@@ -382,7 +727,7 @@ public:
     Atom selectAtom(const Atoms& atoms, const Constraints& constraints) const
     {
         // find biggest in list and pick first item
-        Constraint largestConstraint;
+        const Constraint* largestConstraint = NULL;
         size_t largestConstraintSize = 0;
         for(const Constraint& c : constraints)
         {
@@ -390,16 +735,19 @@ public:
             if(constraintSize > largestConstraintSize)
             {
                 largestConstraintSize = constraintSize;
-                largestConstraint = c;
+                largestConstraint = &c;
             }
         }
 
         // Make sure we are using only constraints that are relevant
-        for(Atom a : largestConstraint)
+        if(largestConstraint)
         {
-            if(atoms.contains(a))
+            for(const Atom& a : *largestConstraint)
             {
-                return a;
+                if(atoms.contains(a))
+                {
+                    return a;
+                }
             }
         }
 
@@ -424,19 +772,114 @@ public:
         return aStar;
     }
 
-    void computeConstrainedCoalitions(Atoms atoms, PositiveConstraints p, NegativeConstraints n,
-            PositiveConstraints pStar, NegativeConstraints nStar, Coalitions& coalitions, AStar& aStar, bool positiveBranch = true, Atom a = Atom())
+    /**
+     * Recursive divide and conquer step, the branches are explored in
+     * parallel if more than one thread has been set
+     */
+    void computeConstrainedCoalitions(const Atoms& atoms, const PositiveConstraints& p, const NegativeConstraints& n,
+            const PositiveConstraints& pStar, const NegativeConstraints& nStar, Coalitions& coalitions, AStar& aStar, bool positiveBranch = true, const Atom& a = Atom())
+    {
+        std::vector<Coalitions> coalitionStructures;
+        explore([this, &atoms, &p, &n, &pStar, &nStar, positiveBranch, &a](Context& context)
+                {
+                    computeConstrainedCoalitions(atoms, p, n, pStar, nStar, context, positiveBranch, a);
+                }, coalitions, aStar, coalitionStructures);
+    }
+
+private:
+    /**
+     * Run an exploration starting from the given root task and merge the
+     * results into the given containers
+     */
+    template<typename F>
+    void explore(F root, Coalitions& coalitions, AStar& aStar, std::vector<Coalitions>& coalitionStructures)
     {
-        std::string label;
-        if(positiveBranch)
+        TaskResult result;
+        if(mNumberOfThreads <= 1)
         {
-            label = "with ";
+            Context context = { NULL, 0, &result };
+            root(context);
         } else {
-            label = "without ";
+            Exploration exploration(mNumberOfThreads);
+            TaskResult* rootResult = &result;
+            ++exploration.pendingTasks;
+            exploration.queues[0].push([&exploration, rootResult, root](size_t worker) mutable
+                    {
+                        Context context = { &exploration, worker, rootResult };
+                        root(context);
+                    });
+
+            boost::thread_group workers;
+            for(size_t i = 0; i < mNumberOfThreads; ++i)
+            {
+                workers.create_thread([&exploration, i]()
+                        {
+                            Task task;
+                            while(true)
+                            {
+                                if(!exploration.take(i, task))
+                                {
+                                    if(exploration.pendingTasks == 0)
+                                    {
+                                        break;
+                                    }
+                                    // Tasks in progress might still add new ones
+                                    boost::this_thread::yield();
+                                    continue;
+                                }
+                                task(i);
+                                task.clear();
+                                --exploration.pendingTasks;
+                            }
+                        });
+            }
+            workers.join_all();
         }
-        label += a.toString();
+        result.mergeInto(coalitions, aStar, coalitionStructures);
+    }
 
-        LOG_DEBUG_S << "compute constrained coalitions [" << label << "]: " << std::endl
+    /**
+     * Check if the exploration of a subtree should be forked, i.e. if the
+     * exploration is parallel and the subtree is large enough -- this is
+     * checked before creating the task, since it copies the state of the subtree
+     * \param numberOfAtoms Number of atoms remaining in the subtree
+     */
+    bool shouldFork(const Context& context, size_t numberOfAtoms) const
+    {
+        return context.exploration && numberOfAtoms >= mParallelCutoff;
+    }
+
+    /**
+     * Fork the exploration of a subtree into a separate task (see shouldFork)
+     */
+    template<typename F>
+    void fork(Context& context, F subtree)
+    {
+        typename TaskResult::Ptr result(new TaskResult());
+        typename TaskResult::Fork fork = { context.result->aStar.size(), context.result->coalitionStructures.size(), result };
+        context.result->forks.push_back(fork);
+
+        Exploration* exploration = context.exploration;
+        ++exploration->pendingTasks;
+        exploration->queues[context.worker].push([exploration, result, subtree](size_t worker) mutable
+                {
+                    Context subtreeContext = { exploration, worker, result.get() };
+                    subtree(subtreeContext);
+                });
+    }
+
+    /**
+     * Recursive divide and conquer step
+     *
+     * The sets are taken by value, since each step modifies its own copy --
+     * callers move them in where they are no longer needed
+     */
+    void computeConstrainedCoalitions(Atoms atoms, PositiveConstraints p, NegativeConstraints n,
+            PositiveConstraints pStar, NegativeConstraints nStar, Context& context, bool positiveBranch, const Atom& a)
+    {
+        Coalitions& coalitions = context.result->coalitions;
+        AStar& aStar = context.result->aStar;
+        LOG_DEBUG_S << "compute constrained coalitions [" << (positiveBranch ? "with " : "without ") << a << "]: " << std::endl
             << "    atoms:        " << atoms.toString() << std::endl
             << "    p:            " << p.toString() << std::endl
             << "    n:            " << n.toString() << std::endl
@@ -447,35 +890,8 @@ public:
         // Remove redundant constraints
         // i.e. find the 'smallest' constrained by removing
         // all superset of an existing constraint
-        {
-            NegativeConstraints tmpN = n;
-
-            for(Constraint nc : tmpN)
-            {
-                for(Constraint nc_s : tmpN)
-                {
-                    if(nc_s.isSupersetOf(nc))
-                    {
-                        n = n.without(nc_s);
-                    }
-                }
-            }
-        }
-
-        {
-            PositiveConstraints tmpP = p;
-
-            for(Constraint pc : tmpP)
-            {
-                for(Constraint pc_s : tmpP)
-                {
-                    if(pc_s.isSupersetOf(pc))
-                    {
-                        p = p.without(pc_s);
-                    }
-                }
-            }
-        }
+        n.removeSupersets();
+        p.removeSupersets();
 
         LOG_DEBUG_S << "Removed redunant: " << std::endl
             << "    atoms:        " << atoms.toString() << std::endl
@@ -490,24 +906,29 @@ public:
         // "Only one constraint, either positive or negative is left to be satisfied", i.e.
         // if there is a constraint in N with exactly one agent
         {
-            NegativeConstraints tmpSet = n;
-            for(Constraint nc : tmpSet)
+            NegativeConstraints remainingN;
+            for(const Constraint& nc : n)
             {
                 if(nc.size() == 1)
                 {
                     LOG_DEBUG_S << "Constraint with exactly one agent: " << nc.toString();
-                    atoms = atoms.without(nc.first());
-                    nStar = nStar.createUnion(nc);
-                    n = n.without(nc);
+                    atoms.erase(nc.first());
+                    nStar.insert(nc);
+                } else {
+                    remainingN.insert(nc);
                 }
             }
+            n = std::move(remainingN);
         }
 
         // By definition if p contains the empty set, all constraints in P are satisfied
         if(p.containsEmptySet() && n.size() == 1)
         {
             LOG_DEBUG_S << "P contains empty set and one negative constraint only" << p.toString();
-            nStar = nStar.createUnion(n);
+            for(const Constraint& nc : n)
+            {
+                nStar.insert(nc);
+            }
             n.clear();
         }
 
@@ -519,7 +940,7 @@ public:
 
             // reset positive constraint set
             p.clear();
-            p = p.createUnion( Constraint() );
+            p.insert( Constraint() );
             LOG_DEBUG_S << "Create p union " << p.toString();
         }
 
@@ -602,17 +1023,13 @@ public:
         // two sets:
         // ncs_ai -> finally contains all subset when substracting 'atom'
         // ncs_not_ai -> finally all subsets that never related to atom
-        for(Constraint nc : n)
+        for(const Constraint& nc : n)
         {
             if( nc.contains(atom) )
             {
-                Constraint constraint = nc.without(atom);
-                //if(!constraint.empty())
-                //{
-                    ncs_ai = ncs_ai.createUnion(constraint);
-                //}
+                ncs_ai.insert( nc.without(atom) );
             } else {
-                ncs_not_ai = ncs_not_ai.createUnion( nc );
+                ncs_not_ai.insert( nc );
             }
         }
 
@@ -623,21 +1040,19 @@ public:
         // to permitted coalitions, when merged with ai
         PositiveConstraints pcs_ai;
 
-        for(Constraint pc : p)
+        for(const Constraint& pc : p)
         {
             if( pc.contains(atom) )
             {
-                Constraint constraint = pc.without(atom);
-                //if(!constraint.empty())
-                //{
-                    pcs_ai = pcs_ai.createUnion(constraint);
-                //}
+                pcs_ai.insert( pc.without(atom) );
             } else {
-                pcs_not_ai = pcs_not_ai.createUnion(pc);
+                pcs_not_ai.insert( pc );
             }
         }
 
-        PositiveConstraints newPStar = PositiveConstraints( pStar.createUnion( PositiveConstraints( atom ) ).flatten() );
+        Constraint newPStarAtoms = pStar.flatten();
+        newPStarAtoms.insert(atom);
+        PositiveConstraints newPStar( newPStarAtoms );
 
         LOG_DEBUG_S << "Prepare divide and conquer for: " << atom << std::endl
             << "    atoms:        " << atoms.toString() << std::endl
@@ -653,17 +1068,30 @@ public:
 
 
         // apply divide and conquer
-        Atoms remainingAtoms = atoms.without(atom);
+        atoms.erase(atom);
         // Positive constraints: pcs_not_ai and pcs_ai -> all coalitions that are allowed joined with those that lead to permitted combinations with ai
         // Negative constraints: ncs_not_ai and ncs_ai -> all coalitions that are not allowed joined with those that lead to prohibited combinations with ai
-        computeConstrainedCoalitions( remainingAtoms , pcs_not_ai.createUnion(pcs_ai), ncs_not_ai.createUnion(ncs_ai), newPStar, nStar, coalitions, aStar, true, atom);
-        computeConstrainedCoalitions( remainingAtoms, pcs_not_ai, ncs_not_ai, pStar, nStar.createUnion(atom), coalitions, aStar, false, atom);
+        PositiveConstraints pcs = pcs_not_ai.createUnion(pcs_ai);
+        NegativeConstraints ncs = ncs_not_ai.createUnion(ncs_ai);
+        if(shouldFork(context, atoms.size()))
+        {
+            fork(context, [this, atoms, pcs, ncs, newPStar, nStar, atom](Context& subtreeContext) mutable
+                    {
+                        computeConstrainedCoalitions( std::move(atoms), std::move(pcs), std::move(ncs), std::move(newPStar), std::move(nStar), subtreeContext, true, atom);
+                    });
+        } else {
+            computeConstrainedCoalitions( atoms, std::move(pcs), std::move(ncs), std::move(newPStar), nStar, context, true, atom);
+        }
+        nStar.insert( Constraint(atom) );
+        computeConstrainedCoalitions( std::move(atoms), std::move(pcs_not_ai), std::move(ncs_not_ai), std::move(pStar), std::move(nStar), context, false, atom);
     }
 
+public:
+
     /**
      * Based on the information on aStar, i.e. the structure of the base cases, we create the necessary set of coalitions
      */
-    CoalitionsList createLists(AStar aStar, Coalitions coalitions)
+    CoalitionsList createLists(const AStar& aStar, const Coalitions& coalitions) const
     {
         LOG_DEBUG_S << "Create " << aStar.size() << " lists";
         CoalitionsList list(aStar.size() + 1);
@@ -676,7 +1104,7 @@ public:
             // Picking a feasible coaltion -- in our case they should be feasible by default
             for(size_t i = 0; i < aStar.size(); ++i)
             {
-                Atom a = aStar[i];
+                const Atom& a = aStar[i];
                 if( coalition.positive.first().contains(a) )
                 {
                     list[i].insert(coalition);
@@ -698,24 +1126,41 @@ public:
         return list;
     }
 
-    bool checkFeasibility(Coalition c)
+    bool checkFeasibility(const Coalition& c)
     {
         return true;
     }
 
+    /**
+     * Compute the feasible coalition structures, the levels are explored in
+     * parallel if more than one thread has been set
+     */
     void computeFeasibleCoalitions(const CoalitionsList& list, std::vector<Coalitions>& coalitions, const Coalitions& baseCoalition = Coalition(), size_t level = 0)
     {
+        Coalitions constrainedCoalitions;
+        AStar aStar;
+        explore([this, &list, &baseCoalition, level](Context& context)
+                {
+                    computeFeasibleCoalitions(list, context, baseCoalition, level);
+                }, constrainedCoalitions, aStar, coalitions);
+    }
+
+private:
+    void computeFeasibleCoalitions(const CoalitionsList& list, Context& context, const Coalitions& baseCoalition, size_t level)
+    {
+        std::vector<Coalitions>& coalitions = context.result->coalitionStructures;
         // Pick coalition
         Coalitions coalitionStructure = baseCoalition;
         for(const Coalition& listCoalition : list[level])
         {
             Coalitions feasibleCoalitions = listCoalition.getFeasibleCoalitions();
-            for(Coalition c : feasibleCoalitions)
+            for(const Coalition& c : feasibleCoalitions)
             {
                 coalitionStructure.insert(c);
 
                 // if(checkFeasibility(coalitionStructure))
-                if(Coalition::getUniqueElements(coalitionStructure).size() == mAtoms.size())
+                size_t numberOfUsedAtoms = Coalition::getUniqueElements(coalitionStructure).size();
+                if(numberOfUsedAtoms == mAtoms.size())
                 {
                     LOG_DEBUG_S << "Check all atoms used in coalition structure, i.e. structure complete: " << coalitionStructure.toString() << " unique elements: " << Coalition::getUniqueElements(coalitionStructure).size() << " atoms: " << mAtoms.size();
                     coalitions.push_back(coalitionStructure);
@@ -742,7 +1187,16 @@ public:
                         }
 
                         LOG_DEBUG_S << "Check feasibility: on level: " << level << " with coalition struct: " << coalitionStructure.toString();
-                        computeFeasibleCoalitions(list, coalitions, coalitionStructure, level);
+                        if(shouldFork(context, mAtoms.size() - numberOfUsedAtoms))
+                        {
+                            const CoalitionsList* levels = &list;
+                            fork(context, [this, levels, coalitionStructure, level](Context& subtreeContext)
+                                    {
+                                        computeFeasibleCoalitions(*levels, subtreeContext, coalitionStructure, level);
+                                    });
+                        } else {
+                            computeFeasibleCoalitions(list, context, coalitionStructure, level);
+                        }
                     } else {
                         LOG_DEBUG_S << "Level " << level << " vs. " << list.size();
                     }
@@ -1,11 +1,11 @@
 #include "Scenario.hpp"
+#include "SpanningTreeEnumeration.hpp"
 #include <numeric/Combinatorics.hpp>
 #include <numeric/LimitedCombination.hpp>
 #include <iostream>
 #include <fstream>
 #include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
-#include "../ModelPool.hpp"
 
 using namespace numeric;
 
@@ -214,8 +214,10 @@ void Scenario::createLinks()
         mActorLinkMap[link.getSecondActor()].insert(link);
     }
 
-    moreorg::ModelPool::Set agentSpaceModelPools;
-    std::set< std::set<Link> > linkSpaceModelPools;
+    // Each type combination has a distinct representative actor combination,
+    // so that the number of types can be aggregated while enumerating
+    uint32_t numberOfAgentSpaceTypes = 0;
+    uint64_t numberOfLinkSpaceTypes = 0;
 
     int count = 0;
     numeric::LimitedCombination<char> linkCombinations(mModelPool, mMaxCoalitionSize, numeric::MAX);
@@ -240,91 +242,28 @@ void Scenario::createLinks()
             actors.erase(it);
         }
 
-        // Find all feasible combinations for this type in link space
-     //   std::cout << "Collect: " << count << std::endl;
-        size_t coalitionSize = std::min(mMaxCoalitionSize, representativeActor.size());
-        Combination<Actor> actorCombination(representativeActor, coalitionSize, EXACT);
-        do {
-            std::vector<Actor> actors = actorCombination.current();
-    //        std::cout << "Actors: " << actors.size() << std::endl;
-            collectCombinations(actors, actors, std::set<Link>(), agentSpaceModelPools, linkSpaceModelPools);
-        } while(actorCombination.next());
+        // Find all feasible combinations for this type in link space, i.e.
+        // all link sets which connect the representative actors
+        uint64_t numberOfLinkSets = countLinkSets(representativeActor);
+        if(numberOfLinkSets > 0)
+        {
+            ++numberOfAgentSpaceTypes;
+            numberOfLinkSpaceTypes += numberOfLinkSets;
+        }
     } while(linkCombinations.next());
 
     mNumberOfActorTypesTheoreticalBound = count;
-    mNumberOfActorTypesAgentSpace = agentSpaceModelPools.size() + mActorTypes.size();
-    mNumberOfActorTypesLinkSpace = linkSpaceModelPools.size() + mActorTypes.size();
+    mNumberOfActorTypesAgentSpace = numberOfAgentSpaceTypes + mActorTypes.size();
+    mNumberOfActorTypesLinkSpace = numberOfLinkSpaceTypes + mActorTypes.size();
 
     std::cout << "Max: " << mMaxCoalitionSize << std::endl;
-    std::cout << "ModelPool: Agents " << agentSpaceModelPools.size() << std::endl << moreorg::ModelPool::toString(agentSpaceModelPools) << std::endl;
-    //std::cout << "ModelPool: Link " << linkSpaceModelPools << std::endl;
+    std::cout << "ModelPool: Agents " << numberOfAgentSpaceTypes << std::endl;
 }
 
-void Scenario::collectCombinations(
-        const std::vector<Actor>& allowedActors,
-        std::vector<Actor> actors, std::set<Link> links,
-        moreorg::ModelPool::Set& agentSpaceModelPools,
-        std::set< std::set<Link> >& linkSpaceSets
-        )
+uint64_t Scenario::countLinkSets(const std::vector<Actor>& actors) const
 {
-    if(actors.size() == 1)
-    {
-        actors.clear();
-
-        std::set<Actor> actors;
-        for(const Link& l : links)
-        {
-            actors.insert(l.getFirstActor());
-            actors.insert(l.getSecondActor());
-        }
-
-        if(actors.size() == links.size() + 1)
-        {
-            moreorg::ModelPool agentSpaceAgentType;
-            moreorg::ModelPool linkSpaceAgentType;
-            for(Actor actor : actors)
-            {
-                std::string id;
-                {
-                    id += (char) actor.getType();
-                    agentSpaceAgentType["http://actor-type#" + id] += 1;
-                }
-            }
-            agentSpaceModelPools.insert(agentSpaceAgentType);
-            linkSpaceSets.insert(links);
-        }
-    } else {
-        std::set<Link> actorLinks = mActorLinkMap[actors.back()];
-        std::set<Link> allowedLinks;
-        for(const Link& l : actorLinks)
-        {
-            Actor a0 = l.getFirstActor();
-            Actor a1 = l.getSecondActor();
-
-            if( actors.end() != std::find(allowedActors.begin(), allowedActors.end(), a0) )
-            {
-                if(actors.end() != std::find(allowedActors.begin(), allowedActors.end(), a1))
-                {
-                    allowedLinks.insert(l);
-                }
-            }
-        }
-        actors.pop_back();
-
-        //std::cout << "ActorLinks: " << allowedLinks.size() << std::endl;
-        //for(const Link& l : allowedLinks)
-        //{
-        //    std::cout << "    " << l << std::endl;
-        //}
-
-        for(const Link& link : allowedLinks)
-        {
-            std::set<Link> addedLink = links;
-            addedLink.insert(link);
-
-            collectCombinations(allowedActors, actors, addedLink, agentSpaceModelPools, linkSpaceSets);
-        }
-    }
+    SpanningTreeEnumeration enumeration(actors, mLinkGroupMap);
+    return enumeration.enumerate();
 }
 
 std::vector<LinkType> Scenario::getValidLinkTypeList() const
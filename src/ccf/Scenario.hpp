@@ -5,7 +5,6 @@
 #include <set>
 #include <vector>
 #include <moreorg/ccf/Link.hpp>
-#include <moreorg/ModelPool.hpp>
 
 namespace multiagent {
 namespace ccf {
@@ -75,11 +74,13 @@ public:
     std::map<Actor, std::set<Link> > getActorLinkMap() const { return mActorLinkMap; }
     std::map<Interface, std::set<Link> > getInterfaceLinkMap() const { return mInterfaceLinkMap; }
 
-    void collectCombinations(
-            const std::vector<Actor>& allowedActors,
-            std::vector<Actor> actors, std::set<Link> links,
-            moreorg::ModelPool::Set& agentSpaceModelPools,
-            std::set< std::set<Link> >& linkSpaceSets);
+    /**
+     * Count the linked combinations of the given actors, i.e. the spanning
+     * trees of their link graph
+     * \return the number of link sets that connect all actors, 0 if the
+     * actors cannot be connected
+     */
+    uint64_t countLinkSets(const std::vector<Actor>& actors) const;
 
     size_t getNumberOfActors() const { return mActors.size(); }
     static Scenario fromConsole();
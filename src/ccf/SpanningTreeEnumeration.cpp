@@ -0,0 +1,124 @@
+#include "SpanningTreeEnumeration.hpp"
+#include <stdexcept>
+
+using namespace moreorg::utils;
+
+namespace multiagent {
+namespace ccf {
+
+SpanningTreeEnumeration::SpanningTreeEnumeration(const std::vector<Actor>& actors, const std::map<LinkGroup, std::set<Link> >& linkGroupMap)
+    : mActors(actors)
+    , mAllActors(0)
+    , mLinks(actors.size()*actors.size())
+    , mAdjacency(actors.size(), 0)
+    , mExcluded(actors.size(), 0)
+    , mNumberOfTrees(0)
+    , mNumberOfLinkSets(0)
+{
+    if(mActors.size() > bitmask::MAX_SIZE)
+    {
+        throw std::invalid_argument("moreorg::ccf::SpanningTreeEnumeration: number of actors exceeds the maximum of 64");
+    }
+    mAllActors = bitmask::first(mActors.size());
+
+    for(size_t i = 0; i < mActors.size(); ++i)
+    {
+        for(size_t j = i + 1; j < mActors.size(); ++j)
+        {
+            std::map<LinkGroup, std::set<Link> >::const_iterator cit = linkGroupMap.find( LinkGroup(mActors[i], mActors[j]) );
+            if(cit == linkGroupMap.end() || cit->second.empty())
+            {
+                continue;
+            }
+
+            mLinks[i*mActors.size() + j].assign(cit->second.begin(), cit->second.end());
+            mLinks[j*mActors.size() + i] = mLinks[i*mActors.size() + j];
+            mAdjacency[i] |= Bitmask(1) << j;
+            mAdjacency[j] |= Bitmask(1) << i;
+        }
+    }
+}
+
+uint64_t SpanningTreeEnumeration::enumerate(TreeCallback callback)
+{
+    mCallback = callback;
+    mNumberOfTrees = 0;
+    mNumberOfLinkSets = 0;
+    mTree.clear();
+    std::fill(mExcluded.begin(), mExcluded.end(), 0);
+
+    if(!mActors.empty() && isConnected(1))
+    {
+        enumerate(1, 1);
+    }
+    mCallback = TreeCallback();
+    return mNumberOfLinkSets;
+}
+
+void SpanningTreeEnumeration::enumerate(ActorSet tree, uint64_t numberOfLinkSets)
+{
+    if(tree == mAllActors)
+    {
+        ++mNumberOfTrees;
+        mNumberOfLinkSets += numberOfLinkSets;
+        if(mCallback)
+        {
+            mCallback(mTree, numberOfLinkSets);
+        }
+        return;
+    }
+
+    // Select the link group from the lowest actor outside the tree that can
+    // be linked to the tree, to the lowest actor in the tree it links to
+    for(ActorSet outside = mAllActors & ~tree; outside; outside &= outside - 1)
+    {
+        size_t actor = bitmask::lowest(outside);
+        ActorSet frontier = mAdjacency[actor] & tree & ~mExcluded[actor];
+        if(!frontier)
+        {
+            continue;
+        }
+        size_t treeActor = bitmask::lowest(frontier);
+
+        // All trees with this link group
+        mTree.push_back( LinkGroup(mActors[treeActor], mActors[actor]) );
+        enumerate(tree | (Bitmask(1) << actor), numberOfLinkSets*getLinks(treeActor, actor).size());
+        mTree.pop_back();
+
+        // All trees without it -- which only exist if the actors remain
+        // connected
+        mExcluded[actor] |= Bitmask(1) << treeActor;
+        if(isConnected(tree))
+        {
+            enumerate(tree, numberOfLinkSets);
+        }
+        mExcluded[actor] &= ~(Bitmask(1) << treeActor);
+        return;
+    }
+}
+
+bool SpanningTreeEnumeration::isConnected(ActorSet tree) const
+{
+    // Link groups between two actors outside the tree are never excluded,
+    // so that it suffices to check the excluded link groups of the actor
+    // that is being reached
+    ActorSet reached = tree;
+    bool extended = true;
+    while(extended)
+    {
+        extended = false;
+        for(ActorSet outside = mAllActors & ~reached; outside; outside &= outside - 1)
+        {
+            size_t actor = bitmask::lowest(outside);
+            if(mAdjacency[actor] & ~mExcluded[actor] & reached)
+            {
+                reached |= Bitmask(1) << actor;
+                extended = true;
+            }
+        }
+    }
+    return reached == mAllActors;
+}
+
+} // end namespace ccf
+} // end namespace multiagent
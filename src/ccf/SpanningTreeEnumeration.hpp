@@ -0,0 +1,117 @@
+#ifndef MULTIAGENT_CCF_SPANNING_TREE_ENUMERATION_HPP
+#define MULTIAGENT_CCF_SPANNING_TREE_ENUMERATION_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <boost/function.hpp>
+#include <moreorg/ccf/Link.hpp>
+#include <moreorg/utils/Bitmask.hpp>
+
+namespace multiagent {
+namespace ccf {
+
+/**
+ * \class SpanningTreeEnumeration
+ * \brief Enumerate the spanning trees of the link graph of a set of actors
+ *
+ * \details
+ * Actors are numbered by their position in the given list, so that a set of
+ * actors is a bitmask. The links between two actors are numbered per link
+ * group, i.e. per pair of actors.
+ *
+ * The spanning trees over the link groups are enumerated canonically, by
+ * growing a tree from the first actor: the link group from the
+ * lowest actor outside the tree to the lowest actor in the tree is either
+ * added to the tree or excluded from all following trees. Hence, each tree
+ * is generated exactly once, and excluding a link group is only
+ * considered if the actors remain connected, so that no branch is a dead
+ * end.
+ * Each tree over link groups represents the product of the number of links
+ * per group distinct sets of links, which are only counted, not generated
+ \verbatim
+    SpanningTreeEnumeration enumeration(actors, linkGroupMap);
+    enumeration.enumerate([](const std::vector<LinkGroup>& tree, uint64_t numberOfLinkSets)
+        {
+            ...
+        });
+    size_t linkSets = enumeration.getNumberOfLinkSets();
+ \endverbatim
+ */
+class SpanningTreeEnumeration
+{
+public:
+    /// Set of actors, where bit i represents the i-th actor
+    typedef moreorg::utils::Bitmask ActorSet;
+
+    /**
+     * Callback for each spanning tree
+     * \param tree the link groups which form the tree
+     * \param numberOfLinkSets the number of link sets which realize this
+     * tree, i.e. the product of the number of links per link group
+     */
+    typedef boost::function<void (const std::vector<LinkGroup>& tree, uint64_t numberOfLinkSets)> TreeCallback;
+
+    /**
+     * \param actors the actors to connect
+     * \param linkGroupMap the (valid) links per link group, groups which do
+     * not connect two of the actors are ignored
+     * \throws std::invalid_argument if more than 64 actors are given
+     */
+    SpanningTreeEnumeration(const std::vector<Actor>& actors, const std::map<LinkGroup, std::set<Link> >& linkGroupMap);
+
+    /**
+     * Enumerate all spanning trees and update the counts
+     * \param callback optional callback for each tree
+     * \return the number of link sets, i.e. of spanning trees in the link graph
+     */
+    uint64_t enumerate(TreeCallback callback = TreeCallback());
+
+    size_t getNumberOfActors() const { return mActors.size(); }
+
+    /**
+     * Get the links between two actors
+     * \param actor0 index of the first actor
+     * \param actor1 index of the second actor
+     */
+    const std::vector<Link>& getLinks(size_t actor0, size_t actor1) const { return mLinks[actor0*mActors.size() + actor1]; }
+
+    /**
+     * Get the number of spanning trees over link groups of the last
+     * enumeration
+     */
+    uint64_t getNumberOfTrees() const { return mNumberOfTrees; }
+
+    /**
+     * Get the number of spanning trees over links of the last enumeration
+     */
+    uint64_t getNumberOfLinkSets() const { return mNumberOfLinkSets; }
+
+private:
+    void enumerate(ActorSet tree, uint64_t numberOfLinkSets);
+
+    /**
+     * Check whether all actors can be reached from the tree without
+     * using excluded link groups
+     */
+    bool isConnected(ActorSet tree) const;
+
+    std::vector<Actor> mActors;
+    ActorSet mAllActors;
+    /// Links per pair of actors (row-major), symmetric
+    std::vector< std::vector<Link> > mLinks;
+    /// Actors which are linked to an actor
+    std::vector<ActorSet> mAdjacency;
+    /// Actors (in the tree) to which the link group of an actor has been
+    /// excluded in the current branch
+    std::vector<ActorSet> mExcluded;
+
+    std::vector<LinkGroup> mTree;
+    TreeCallback mCallback;
+    uint64_t mNumberOfTrees;
+    uint64_t mNumberOfLinkSets;
+};
+
+} // end namespace ccf
+} // end namespace multiagent
+#endif // MULTIAGENT_CCF_SPANNING_TREE_ENUMERATION_HPP
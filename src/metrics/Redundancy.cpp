@@ -54,6 +54,49 @@ double Redundancy::computeSequential(const std::vector<owlapi::model::IRISet>& f
     return serial(metrics);
 }
 
+uint32_t Redundancy::computeFullModelRedundancy(const reasoning::ModelBound::List& required,
+        const reasoning::ModelBound::List& available,
+        reasoning::ModelBound::List& remaining,
+        bool iterative) const
+{
+    using namespace moreorg::reasoning;
+
+    if(!iterative)
+    {
+        ModelBound::List modelBoundRemaining;
+        uint32_t fullModelRedundancy = ResourceMatch::getMaxNumberOfAssignments(required, available,
+                mOrganizationModelAsk.getOrganizationModel()->ontology(), &modelBoundRemaining);
+        remaining = modelBoundRemaining;
+        return fullModelRedundancy;
+    }
+
+    ModelBound::List modelBoundRemaining = available;
+    ResourceMatch::Solution solution;
+    uint32_t fullModelRedundancy = 0;
+    try {
+
+        // Check how often a full redundancy of the top level model is given
+        while(true)
+        {
+            solution = ResourceMatch::solve(required, modelBoundRemaining, mOrganizationModelAsk);
+            ++fullModelRedundancy;
+            // Remove the consumed models from the list of available and try to
+            // repeat solving
+            // throws invalid_argument when model bounds are exceeded
+            modelBoundRemaining = solution.substractMinFrom(modelBoundRemaining);
+            LOG_DEBUG_S
+                << "Solution: " << solution.toString()
+                << std::endl
+                << "Remaining: " << ModelBound::toString(modelBoundRemaining);
+        }
+    } catch(const std::exception& e)
+    {
+        LOG_DEBUG_S << "ResourceMatch failed: " << e.what();
+    }
+    remaining = modelBoundRemaining;
+    return fullModelRedundancy;
+}
+
 double Redundancy::computeMetric(const std::vector<OWLCardinalityRestriction::Ptr>& required, const std::vector<OWLCardinalityRestriction::Ptr>& available) const
 {
     if(required.empty())
@@ -96,28 +139,7 @@ double Redundancy::computeMetric(const std::vector<OWLCardinalityRestriction::Pt
         << std::endl
         << "Required: " << ModelBound::toString(modelBoundRequired);
 
-    ResourceMatch::Solution solution;
-    uint32_t fullModelRedundancy = 0;
-    try {
-
-        // Check how often a full redundancy of the top level model is given
-        while(true)
-        {
-            solution = ResourceMatch::solve(modelBoundRequired, modelBoundRemaining, mOrganizationModelAsk);
-            ++fullModelRedundancy;
-            // Remove the consumed models from the list of available and try to
-            // repeat solving
-            // throws invalid_argument when model bounds are exceeded
-            modelBoundRemaining = solution.substractMinFrom(modelBoundRemaining);
-            LOG_DEBUG_S
-                << "Solution: " << solution.toString()
-                << std::endl
-                << "Remaining: " << ModelBound::toString(modelBoundRemaining);
-        }
-    } catch(const std::exception& e)
-    {
-        LOG_DEBUG_S << "ResourceMatch failed: " << e.what();
-    }
+    uint32_t fullModelRedundancy = computeFullModelRedundancy(modelBoundRequired, modelBoundRemaining, modelBoundRemaining);
 
     LOG_INFO_S << "Full model redundancy count is at: " << fullModelRedundancy << std::endl
         << "   remaining: " << ModelBound::toString(modelBoundRemaining, 8);
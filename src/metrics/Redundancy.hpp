@@ -4,6 +4,7 @@
 #include <moreorg/OrganizationModel.hpp>
 #include <moreorg/Metric.hpp>
 #include "../vocabularies/OM.hpp"
+#include "../reasoning/ModelBound.hpp"
 
 namespace moreorg {
 namespace metrics {
@@ -39,6 +40,21 @@ public:
     double computeMetric(const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& required,
             const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& available) const;
 
+    /**
+     * Compute the full model redundancy, i.e. how often the required resources
+     * can be covered by the available resources at the same time
+     * \param remaining Set to the resources which remain after removing all
+     * full assignments
+     * \param iterative If true, solve one ResourceMatch per full assignment
+     * and remove it before solving again, otherwise compute the count in one
+     * max-flow formulation (see ResourceMatch::getMaxNumberOfAssignments)
+     * \return number of full assignments
+     */
+    uint32_t computeFullModelRedundancy(const reasoning::ModelBound::List& required,
+            const reasoning::ModelBound::List& available,
+            reasoning::ModelBound::List& remaining,
+            bool iterative = false) const;
+
     double computeSequential(const owlapi::model::IRIList& functions, const ModelPool& modelPool) const;
     double computeSequential(const std::vector<owlapi::model::IRISet>& functionalRequirement, const ModelPool& modelPool, bool sharedUse = true) const;
 
@@ -133,12 +133,52 @@ ResourceInstanceMatch::ResourceInstanceMatch(const ModelBound::List& required,
 
 }
 
+ResourceInstanceMatch::ResourceInstanceMatch(const ModelBound::List& required,
+        const ResourceInstance::List& available,
+        OrganizationModelAsk ask,
+        bool openAvailability)
+    : mRequiredModelBound(required)
+    , mAvailableResources(available)
+    , mModelAssignment(*this, available.size()*required.size(), 0, 1)
+    , mAvailability(*this, openAvailability ? available.size() : 0, 0, 1)
+{
+    Gecode::Matrix<Gecode::IntVarArray> modelAssignment(mModelAssignment,
+            /*width --> col*/ available.size(), /* height --> row*/ required.size());
+
+    for(size_t ri = 0; ri < mRequiredModelBound.size(); ++ri)
+    {
+        const ModelBound& requiredModelBound = mRequiredModelBound[ri];
+        Gecode::IntVarArgs args;
+        for(size_t ai = 0; ai < mAvailableResources.size(); ++ai)
+        {
+            Gecode::IntVar m = modelAssignment(ai, ri);
+            args << m;
+
+            const owlapi::model::IRI& availableModel = mAvailableResources[ai].getModel();
+            if(requiredModelBound.model == availableModel || ask.ontology().isSubClassOf(availableModel, requiredModelBound.model))
+            {
+                rel(*this, m, Gecode::IRT_LQ, requiredModelBound.max);
+                if(openAvailability)
+                {
+                    rel(*this, m <= mAvailability[ai]);
+                }
+            } else {
+                rel(*this, m, Gecode::IRT_EQ, 0);
+            }
+        }
+        rel(*this, sum(args) >= requiredModelBound.min);
+    }
+
+    branch(*this, mModelAssignment, Gecode::INT_VAR_MIN_MIN(), Gecode::INT_VAL_SPLIT_MIN());
+}
+
 ResourceInstanceMatch::ResourceInstanceMatch(ResourceInstanceMatch& other)
     : Gecode::Space(other)
     , mRequiredModelBound(other.mRequiredModelBound)
     , mAvailableResources(other.mAvailableResources)
 {
     mModelAssignment.update(*this,other.mModelAssignment);
+    mAvailability.update(*this,other.mAvailability);
 }
 
 Gecode::Space* ResourceInstanceMatch::copy()
@@ -165,6 +205,59 @@ ResourceInstanceMatch::Solution ResourceInstanceMatch::solve(const ModelBound::L
     return solution;
 }
 
+ResourceInstanceMatch::Compiled::Compiled(const ModelBound::List& required,
+        const ResourceInstance::List& resources,
+        const OrganizationModelAsk& ask)
+    : mResources(resources)
+    , mpBaseSpace(new ResourceInstanceMatch(required, resources, ask, true))
+{
+    // Propagate the structural constraints once, so that clones start
+    // from the fixpoint
+    if(mpBaseSpace->status() == Gecode::SS_FAILED)
+    {
+        delete mpBaseSpace;
+        mpBaseSpace = NULL;
+    }
+}
+
+ResourceInstanceMatch::Compiled::~Compiled()
+{
+    delete mpBaseSpace;
+}
+
+ResourceInstanceMatch::Solution ResourceInstanceMatch::Compiled::solve(const std::vector<bool>& availability) const
+{
+    if(availability.size() != mResources.size())
+    {
+        throw std::invalid_argument("moreorg::reasoning::ResourceInstanceMatch::Compiled::solve: expected "
+                + std::to_string(mResources.size()) + " availability flags, but got "
+                + std::to_string(availability.size()));
+    }
+    if(mpBaseSpace == NULL)
+    {
+        throw std::runtime_error("moreorg::reasoning::ResourceInstanceMatch: no solution found");
+    }
+
+    ResourceInstanceMatch* match = static_cast<ResourceInstanceMatch*>(mpBaseSpace->clone());
+    for(size_t ai = 0; ai < availability.size(); ++ai)
+    {
+        rel(*match, match->mAvailability[ai], Gecode::IRT_EQ, availability[ai] ? 1 : 0);
+    }
+
+    ResourceInstanceMatch* solvedMatch = NULL;
+    try {
+        solvedMatch = match->solve();
+    } catch(...)
+    {
+        delete match;
+        throw;
+    }
+    delete match;
+
+    Solution solution = solvedMatch->getSolution();
+    delete solvedMatch;
+    return solution;
+}
 
 ResourceInstanceMatch::Solution ResourceInstanceMatch::getSolution() const
 {
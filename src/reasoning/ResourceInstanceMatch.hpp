@@ -87,6 +87,10 @@ class ResourceInstanceMatch : public Gecode::Space
      */
     Gecode::IntVarArray mModelAssignment;
 
+    /// Availability (0 or 1) per resource instance, only used by a compiled
+    /// base space (see ResourceInstanceMatch::Compiled)
+    Gecode::IntVarArray mAvailability;
+
     ResourceInstanceMatch* solve();
 
 protected:
@@ -94,6 +98,15 @@ protected:
             const ResourceInstance::List& provided,
             OrganizationModelAsk ask);
 
+    /**
+     * Create the base space for a compiled match: the availability of the
+     * resource instances remains open as variables mAvailability
+     */
+    ResourceInstanceMatch(const ModelBound::List& required,
+            const ResourceInstance::List& provided,
+            OrganizationModelAsk ask,
+            bool openAvailability);
+
     /**
      * Search support
      * This copy constructor is required for the search engine
@@ -139,6 +152,51 @@ public:
         std::map<ModelBound, ResourceInstance::List> mAssignments;
     };
 
+    /**
+     * \class Compiled
+     * \brief Match with pre-posted structural constraints for repeated solves
+     * over subsets of the same resource instances
+     *
+     * The requirements and the compatibility with all resource instances
+     * are posted once into a base space. For each query, the base space is
+     * cloned and only the availability of the instances is set.
+     * A compiled match is not thread-safe, so use one per thread
+     */
+    class Compiled
+    {
+    public:
+        typedef shared_ptr<Compiled> Ptr;
+
+        /**
+         * \param required Required model bounds
+         * \param resources All resource instances that might become available
+         */
+        Compiled(const ModelBound::List& required,
+                const ResourceInstance::List& resources,
+                const OrganizationModelAsk& ask);
+
+        ~Compiled();
+
+        /**
+         * Check if the available resource instances fulfill the requirements
+         * \param availability Flag per compiled resource instance, true if
+         * the instance is available
+         * \throws std::invalid_argument if the number of flags does not match the number of resources
+         * \throws std::runtime_error if no solution exists
+         */
+        Solution solve(const std::vector<bool>& availability) const;
+
+        const ResourceInstance::List& getResources() const { return mResources; }
+
+    private:
+        Compiled(const Compiled& other);
+        Compiled& operator=(const Compiled& other);
+
+        ResourceInstance::List mResources;
+        /// Base space, or NULL if the structural constraints already fail
+        ResourceInstanceMatch* mpBaseSpace;
+    };
+
     ResourceInstanceMatch::Solution getSolution() const;
 
     void print(std::ostream& os) const;
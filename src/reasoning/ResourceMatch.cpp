@@ -1,11 +1,15 @@
 
 #include <numeric/Combinatorics.hpp>
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <gecode/minimodel.hh>
 #include <gecode/gist.hh>
 #include <moreorg/vocabularies/OM.hpp>
 
 #include "ResourceMatch.hpp"
+#include "../utils/MaxFlow.hpp"
+#include "SupportTable.hpp"
 
 using namespace owlapi::model;
 
@@ -191,18 +195,14 @@ ResourceMatch::Solution ResourceMatch::solve(const std::vector<owlapi::model::OW
     return solve(required, available, ontology);
 }
 
-ResourceMatch::Solution ResourceMatch::solve(const ModelBound::List& required,
-        const ModelBound::List& _available,
-        const OWLOntology::Ptr& ontology)
+ModelBound::List ResourceMatch::aggregateSubclasses(const ModelBound::List& _available,
+        const owlapi::model::OWLOntologyAsk& ask)
 {
-
     if(_available.empty())
     {
         throw std::runtime_error("moreorg::reasoning::ResourceMatch::solve: no available models");
     }
 
-    owlapi::model::OWLOntologyAsk ask(ontology);
-
     ModelBound::List available = _available;
     for(size_t a = 0; a < available.size()-1; ++a)
     {
@@ -218,6 +218,31 @@ ResourceMatch::Solution ResourceMatch::solve(const ModelBound::List& required,
             }
         }
     }
+    return available;
+}
+
+ResourceMatch::Solution ResourceMatch::solve(const ModelBound::List& required,
+        const ModelBound::List& _available,
+        const OWLOntology::Ptr& ontology)
+{
+    owlapi::model::OWLOntologyAsk ask(ontology);
+    ModelBound::List available = aggregateSubclasses(_available, ask);
+
+    LOG_DEBUG_S << "Solve (max-flow):" << std::endl
+        << "    required: " << std::endl
+        << "    " << ModelBound::toString(required, 8) << std::endl
+        << "    available: " << std::endl
+        << "    " << ModelBound::toString(available, 8) << std::endl;
+
+    return solveMaxFlow(required, available, ask);
+}
+
+ResourceMatch::Solution ResourceMatch::solveCSP(const ModelBound::List& required,
+        const ModelBound::List& _available,
+        const OWLOntology::Ptr& ontology)
+{
+    owlapi::model::OWLOntologyAsk ask(ontology);
+    ModelBound::List available = aggregateSubclasses(_available, ask);
 
     LOG_INFO_S << "Solve:" << std::endl
         << "    required: " << std::endl
@@ -236,6 +261,67 @@ ResourceMatch::Solution ResourceMatch::solve(const ModelBound::List& required,
     return solution;
 }
 
+ResourceMatch::Solution ResourceMatch::solveMaxFlow(const ModelBound::List& required,
+        const ModelBound::List& available,
+        const owlapi::model::OWLOntologyAsk& ask)
+{
+    // Nodes: source, requirements, available models, sink
+    size_t source = 0;
+    size_t sink = 1 + required.size() + available.size();
+    utils::MaxFlow flow(sink + 1);
+
+    int64_t requiredTotal = 0;
+    // Edge index per cell of the assignment matrix, or -1 if the available
+    // model does not support the required
+    std::vector<int64_t> assignmentEdges(required.size()*available.size(), -1);
+    for(size_t ri = 0; ri < required.size(); ++ri)
+    {
+        const ModelBound& requiredModelBound = required[ri];
+        flow.addEdge(source, 1 + ri, requiredModelBound.min);
+        requiredTotal += requiredModelBound.min;
+
+        for(size_t ai = 0; ai < available.size(); ++ai)
+        {
+            const ModelBound& availableModelBound = available[ai];
+            if(requiredModelBound.model == availableModelBound.model
+                    || ask.isSubClassOf(availableModelBound.model, requiredModelBound.model))
+            {
+                assignmentEdges[ri*available.size() + ai] = flow.addEdge(1 + ri, 1 + required.size() + ai,
+                        std::min(requiredModelBound.max, availableModelBound.max));
+            }
+        }
+    }
+    for(size_t ai = 0; ai < available.size(); ++ai)
+    {
+        flow.addEdge(1 + required.size() + ai, sink, available[ai].max);
+    }
+
+    if(flow.solve(source, sink) != requiredTotal)
+    {
+        throw std::runtime_error("moreorg::reasoning::ResourceMatch: no solution found");
+    }
+
+    // Same layout as getSolution
+    Solution solution;
+    for(size_t ai = 0; ai < available.size(); ++ai)
+    {
+        for(size_t ri = 0; ri < required.size(); ++ri)
+        {
+            int64_t edge = assignmentEdges[ri*available.size() + ai];
+            if(edge < 0)
+            {
+                continue;
+            }
+            uint32_t value = flow.getFlow(edge);
+            if(value != 0)
+            {
+                solution.addAssignment(required[ri], ModelBound(available[ai].model, value, value));
+            }
+        }
+    }
+    return solution;
+}
+
 ResourceMatch::Solution ResourceMatch::solve(const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& modelRequirements,
         const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& providerResources,
         const OrganizationModelAsk& ask)
@@ -341,12 +427,27 @@ bool ResourceMatch::isSupporting(const owlapi::model::IRI& providerModel,
         OWLOntology::Ptr ontology,
         const owlapi::model::IRI& objectProperty)
 {
+    SupportTable::Ptr supportTable = SupportTable::getInstance(ontology);
+    IRIList combination = { providerModel };
+    bool supporting = false;
+    if(supportTable->lookup(combination, serviceModel, objectProperty, supporting))
+    {
+        return supporting;
+    }
+
     OWLOntologyAsk ask(ontology);
 
     std::vector<OWLCardinalityRestriction::Ptr> providerRestrictions = ask.getCardinalityRestrictions(providerModel, objectProperty);
     std::vector<OWLCardinalityRestriction::Ptr> serviceRestrictions = ask.getCardinalityRestrictions(serviceModel, objectProperty);
 
-    return isSupporting(providerRestrictions, serviceRestrictions, ontology);
+    supporting = isSupporting(providerRestrictions, serviceRestrictions, ontology);
+    // Service models without restrictions are handled differently by
+    // filterSupportedModels, so that only restricted ones are stored
+    if(!serviceRestrictions.empty())
+    {
+        supportTable->insert(combination, serviceModel, objectProperty, supporting);
+    }
+    return supporting;
 }
 
 bool ResourceMatch::isSupporting(const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& providerRestrictions,
@@ -373,16 +474,36 @@ owlapi::model::IRIList ResourceMatch::filterSupportedModels(const ModelPool& mod
 owlapi::model::IRIList ResourceMatch::filterSupportedModels(const owlapi::model::IRIList& combinations,
         const owlapi::model::IRIList& resourceModels, owlapi::model::OWLOntology::Ptr ontology, const owlapi::model::IRI& objectProperty)
 {
+    SupportTable::Ptr supportTable = SupportTable::getInstance(ontology);
     OWLOntologyAsk ask(ontology);
-    std::vector<OWLCardinalityRestriction::Ptr> providerRestrictions = ask.getCardinalityRestrictions(combinations, objectProperty);
+    // Retrieved only if a lookup fails
+    std::vector<OWLCardinalityRestriction::Ptr> providerRestrictions;
+    bool hasProviderRestrictions = false;
     owlapi::model::IRIList supportedModels;
 
     owlapi::model::IRIList::const_iterator it = resourceModels.begin();
     for(; it != resourceModels.end(); ++it)
     {
         owlapi::model::IRI resourceModel = *it;
+        bool supporting = false;
+        if(supportTable->lookup(combinations, resourceModel, objectProperty, supporting))
+        {
+            if(supporting)
+            {
+                supportedModels.push_back(resourceModel);
+            }
+            continue;
+        }
+
+        if(!hasProviderRestrictions)
+        {
+            providerRestrictions = ask.getCardinalityRestrictions(combinations, objectProperty);
+            hasProviderRestrictions = true;
+        }
+
         std::vector<OWLCardinalityRestriction::Ptr> resourceRestrictions = ask.getCardinalityRestrictions(resourceModel, objectProperty);
-        if(resourceRestrictions.empty())
+        bool isUnrestricted = resourceRestrictions.empty();
+        if(isUnrestricted)
         {
             OWLClassExpression::Ptr resourceModelExpression =
                 ask.getOWLClassExpression(resourceModel);
@@ -400,7 +521,13 @@ owlapi::model::IRIList ResourceMatch::filterSupportedModels(const owlapi::model:
             << " vs provided from '" << combinations << "' : "
             << "restrictions: " << OWLCardinalityRestriction::toString(providerRestrictions);
 
-        if( ResourceMatch::isSupporting(providerRestrictions, resourceRestrictions, ontology))
+        supporting = ResourceMatch::isSupporting(providerRestrictions, resourceRestrictions, ontology);
+        if(!isUnrestricted)
+        {
+            supportTable->insert(combinations, resourceModel, objectProperty, supporting);
+        }
+
+        if(supporting)
         {
             supportedModels.push_back(resourceModel);
 
@@ -412,6 +539,124 @@ owlapi::model::IRIList ResourceMatch::filterSupportedModels(const owlapi::model:
     return supportedModels;
 }
 
+uint32_t ResourceMatch::getMaxNumberOfAssignments(const ModelBound::List& required,
+        const ModelBound::List& available,
+        const OWLOntology::Ptr& ontology,
+        ModelBound::List* remaining)
+{
+    if(!hasMinRequirements(required))
+    {
+        throw std::invalid_argument("moreorg::reasoning::ResourceMatch::getMaxNumberOfAssignments:"
+                " no minimum requirements given");
+    }
+
+    owlapi::model::OWLOntologyAsk ask(ontology);
+
+    // Nodes: source, requirements, available models, sink
+    size_t source = 0;
+    size_t sink = 1 + required.size() + available.size();
+    utils::MaxFlow flow(sink + 1);
+
+    int64_t requiredTotal = 0;
+    // Upper bound for the number of assignments
+    int64_t maxCount = std::numeric_limits<int64_t>::max();
+    std::vector<size_t> requirementEdges;
+    std::vector< std::pair<size_t, int64_t> > assignmentEdges;
+    for(size_t ri = 0; ri < required.size(); ++ri)
+    {
+        const ModelBound& requiredModelBound = required[ri];
+        requirementEdges.push_back(flow.addEdge(source, 1 + ri, 0));
+        requiredTotal += requiredModelBound.min;
+
+        int64_t supply = 0;
+        for(size_t ai = 0; ai < available.size(); ++ai)
+        {
+            const ModelBound& availableModelBound = available[ai];
+            if(requiredModelBound.model == availableModelBound.model
+                    || ask.isSubClassOf(availableModelBound.model, requiredModelBound.model))
+            {
+                // a single assignment is bound by the max of both
+                int64_t bound = std::min(requiredModelBound.max, availableModelBound.max);
+                assignmentEdges.push_back(std::make_pair(flow.addEdge(1 + ri, 1 + required.size() + ai, 0), bound));
+                supply += availableModelBound.max;
+            }
+        }
+        if(requiredModelBound.min > 0)
+        {
+            maxCount = std::min(maxCount, supply / requiredModelBound.min);
+        }
+    }
+
+    std::vector<size_t> availableEdges;
+    for(size_t ai = 0; ai < available.size(); ++ai)
+    {
+        availableEdges.push_back(flow.addEdge(1 + required.size() + ai, sink, available[ai].max));
+    }
+
+    // Check whether count assignments can be fulfilled at the same time
+    std::function<bool(int64_t)> isFeasible = [&](int64_t count)
+    {
+        for(size_t ri = 0; ri < required.size(); ++ri)
+        {
+            flow.setCapacity(requirementEdges[ri], count*required[ri].min);
+        }
+        for(const std::pair<size_t, int64_t>& edge : assignmentEdges)
+        {
+            flow.setCapacity(edge.first, count*edge.second);
+        }
+        return flow.solve(source, sink) == count*requiredTotal;
+    };
+
+    // Feasibility is monotonic in the count, so bisect
+    int64_t low = 0;
+    int64_t high = maxCount;
+    while(low < high)
+    {
+        int64_t count = low + (high - low + 1)/2;
+        if(isFeasible(count))
+        {
+            low = count;
+        } else {
+            high = count - 1;
+        }
+    }
+
+    if(remaining)
+    {
+        // Each available resource is charged with the flow it supplied
+        isFeasible(low);
+        *remaining = available;
+        for(size_t ai = 0; ai < available.size(); ++ai)
+        {
+            uint32_t used = flow.getFlow(availableEdges[ai]);
+            ModelBound& remainingModelBound = (*remaining)[ai];
+            remainingModelBound.min = remainingModelBound.min > used ? remainingModelBound.min - used : 0;
+            remainingModelBound.max -= used;
+        }
+    }
+    return low;
+}
+
+void ResourceMatch::prepareSupportTable(const ModelPool& modelPool,
+        const owlapi::model::IRIList& serviceModels,
+        owlapi::model::OWLOntology::Ptr ontology,
+        const owlapi::model::IRI& objectProperty)
+{
+    for(const ModelPool::value_type& v : modelPool)
+    {
+        if(v.second == 0)
+        {
+            continue;
+        }
+        IRIList combination = { v.first };
+        filterSupportedModels(combination, serviceModels, ontology, objectProperty);
+    }
+    filterSupportedModels(modelPool, serviceModels, ontology, objectProperty);
+
+    LOG_DEBUG_S << "Support table prepared with " << SupportTable::getInstance(ontology)->size()
+        << " entries";
+}
+
 bool ResourceMatch::hasMinRequirements(const ModelBound::List& list)
 {
     for(const ModelBound& bound : list)
@@ -156,10 +156,29 @@ public:
             const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& providerResources,
             const owlapi::model::OWLOntology::Ptr& ontology);
 
+    /**
+     * Check if the available resources fulfill the model requirements
+     *
+     * The matching is a transportation problem, which is solved as
+     * capacitated max-flow, i.e. without a general CSP search
+     * \throws std::runtime_error if no solution exists
+     */
     static ResourceMatch::Solution solve(const ModelBound::List& required,
             const ModelBound::List& available,
             const owlapi::model::OWLOntology::Ptr& ontology);
 
+    /**
+     * Check if the available resources fulfill the model requirements by
+     * solving the CSP formulation with Gecode
+     *
+     * Results are equivalent to solve, so this is only required for
+     * (derived) formulations which add further constraints
+     * \throws std::runtime_error if no solution exists
+     */
+    static ResourceMatch::Solution solveCSP(const ModelBound::List& required,
+            const ModelBound::List& available,
+            const owlapi::model::OWLOntology::Ptr& ontology);
+
     static ResourceMatch::Solution solve(const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& modelRequirements,
             const std::vector<owlapi::model::OWLCardinalityRestriction::Ptr>& providerResources,
             const OrganizationModelAsk& ontologyAsk);
@@ -184,6 +203,8 @@ public:
 
     /**
      * Check if the serviceModel is supported by the providerModel
+     * Results are memoized per ontology in a SupportTable, so call
+     * SupportTable::clear after modifying the ontology
      * \param providerModel
      * \param serviceModel
      * \param resourceMatch
@@ -216,11 +237,63 @@ public:
             const owlapi::model::IRIList& serviceModels, owlapi::model::OWLOntology::Ptr ontology,
             const owlapi::model::IRI& objectProperty = vocabulary::OM::has());
 
+    /**
+     * Fill the support table of the ontology (see SupportTable) for the
+     * models of the model pool -- individually and combined -- and the given
+     * service models, so that subsequent calls to isSupporting and
+     * filterSupportedModels for these reduce to table lookups
+     */
+    static void prepareSupportTable(const ModelPool& modelPool,
+            const owlapi::model::IRIList& serviceModels,
+            owlapi::model::OWLOntology::Ptr ontology,
+            const owlapi::model::IRI& objectProperty = vocabulary::OM::has());
+
+    /**
+     * Compute the maximum number of disjoint full assignments, i.e. how often
+     * the minimum requirements can be fulfilled by the available resources at
+     * the same time
+     *
+     * The count is computed with an integer max-flow from the requirements
+     * (capacity: count*min) via the compatible available models (same model or
+     * subclass) to the available resources (capacity: max), where the count is
+     * identified by bisection. Subclass models are not aggregated into their
+     * superclass as in solve, since the subclass edges already allow to use
+     * them and aggregating would count the same resources twice
+     * \param remaining If given, set to the available resources which remain
+     * after removing all assignments
+     * \return number of disjoint full assignments
+     * \throws std::invalid_argument if the requirements contain no minimum
+     * requirements
+     */
+    static uint32_t getMaxNumberOfAssignments(const ModelBound::List& required,
+            const ModelBound::List& available,
+            const owlapi::model::OWLOntology::Ptr& ontology,
+            ModelBound::List* remaining = NULL);
+
     /**
      * Check if the model bound list contains minimum requirements, i.e.
      * if any of the model bounds min in > 0
      */
     static bool hasMinRequirements(const ModelBound::List& list);
+
+private:
+    /**
+     * Add the bounds of subclass models to the bounds of the (available)
+     * superclass model
+     * \throws std::runtime_error if no models are available
+     */
+    static ModelBound::List aggregateSubclasses(const ModelBound::List& available,
+            const owlapi::model::OWLOntologyAsk& ask);
+
+    /**
+     * Solve the matching as capacitated max-flow from the requirements (min)
+     * via the supporting available models (max of both) to the available
+     * models (max)
+     * \throws std::runtime_error if no solution exists
+     */
+    static Solution solveMaxFlow(const ModelBound::List& required,
+            const ModelBound::List& available,
+            const owlapi::model::OWLOntologyAsk& ask);
 };
 
 } // end namespace reasoning
@@ -0,0 +1,131 @@
+#include "SupportTable.hpp"
+#include <algorithm>
+
+using namespace owlapi::model;
+
+namespace moreorg {
+namespace reasoning {
+
+boost::mutex SupportTable::msTablesMutex;
+std::map<const OWLOntology*, SupportTable::Ptr> SupportTable::msTables;
+
+SupportTable::SupportTable()
+{}
+
+SupportTable::Ptr SupportTable::getInstance(const OWLOntology::Ptr& ontology)
+{
+    boost::unique_lock<boost::mutex> lock(msTablesMutex);
+    std::map<const OWLOntology*, SupportTable::Ptr>::iterator it = msTables.find(ontology.get());
+    if(it != msTables.end())
+    {
+        // The address might have been reused by a new ontology
+        if(!it->second->mOntology.expired())
+        {
+            return it->second;
+        }
+        msTables.erase(it);
+    }
+
+    SupportTable::Ptr table = make_shared<SupportTable>();
+    table->mOntology = ontology;
+    msTables[ontology.get()] = table;
+    return table;
+}
+
+void SupportTable::clear(const OWLOntology::Ptr& ontology)
+{
+    boost::unique_lock<boost::mutex> lock(msTablesMutex);
+    msTables.erase(ontology.get());
+}
+
+bool SupportTable::lookup(const IRIList& providerModels,
+        const IRI& serviceModel,
+        const IRI& objectProperty,
+        bool& supporting) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(mMutex);
+    Key key;
+    if(!findKey(providerModels, serviceModel, objectProperty, key))
+    {
+        return false;
+    }
+
+    std::map<Key, bool>::const_iterator cit = mEntries.find(key);
+    if(cit == mEntries.end())
+    {
+        return false;
+    }
+    supporting = cit->second;
+    return true;
+}
+
+void SupportTable::insert(const IRIList& providerModels,
+        const IRI& serviceModel,
+        const IRI& objectProperty,
+        bool supporting)
+{
+    IRIList combination = providerModels;
+    std::sort(combination.begin(), combination.end());
+
+    boost::unique_lock<boost::shared_mutex> lock(mMutex);
+    std::map<IRIList, uint32_t>::const_iterator cit = mProviderIds.find(combination);
+    uint32_t providerId;
+    if(cit == mProviderIds.end())
+    {
+        providerId = mProviderIds.size();
+        mProviderIds[combination] = providerId;
+    } else {
+        providerId = cit->second;
+    }
+
+    Key key(providerId, intern(serviceModel), intern(objectProperty));
+    mEntries[key] = supporting;
+}
+
+size_t SupportTable::size() const
+{
+    boost::shared_lock<boost::shared_mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+bool SupportTable::findKey(const IRIList& providerModels,
+        const IRI& serviceModel,
+        const IRI& objectProperty,
+        Key& key) const
+{
+    IRIList combination = providerModels;
+    std::sort(combination.begin(), combination.end());
+
+    std::map<IRIList, uint32_t>::const_iterator pit = mProviderIds.find(combination);
+    if(pit == mProviderIds.end())
+    {
+        return false;
+    }
+    std::map<IRI, uint32_t>::const_iterator sit = mIds.find(serviceModel);
+    if(sit == mIds.end())
+    {
+        return false;
+    }
+    std::map<IRI, uint32_t>::const_iterator oit = mIds.find(objectProperty);
+    if(oit == mIds.end())
+    {
+        return false;
+    }
+    key = Key(pit->second, sit->second, oit->second);
+    return true;
+}
+
+uint32_t SupportTable::intern(const IRI& iri)
+{
+    std::map<IRI, uint32_t>::const_iterator cit = mIds.find(iri);
+    if(cit != mIds.end())
+    {
+        return cit->second;
+    }
+    uint32_t id = mIds.size();
+    mIds[iri] = id;
+    return id;
+}
+
+} // end namespace reasoning
+} // end namespace moreorg
@@ -0,0 +1,106 @@
+#ifndef ORGANIZATION_MODEL_REASONING_SUPPORT_TABLE_HPP
+#define ORGANIZATION_MODEL_REASONING_SUPPORT_TABLE_HPP
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <owlapi/model/IRI.hpp>
+#include <owlapi/model/OWLOntology.hpp>
+#include "../SharedPtr.hpp"
+
+namespace moreorg {
+namespace reasoning {
+
+/**
+ * \class SupportTable
+ * \brief Memo table for the support of service models by provider models
+ *
+ * \details
+ * Whether a (combination of) provider model(s) supports a service model
+ * depends only on the models and the object property, so that the result of
+ * ResourceMatch::isSupporting can be stored per ontology.
+ * Models and properties are interned, so that an entry is keyed by
+ * (provider, service, property) ids.
+ *
+ * Lookups can be performed concurrently, insertions are exclusive.
+ * The table is not updated when the ontology changes, so call clear after
+ * modifying the ontology
+ */
+class SupportTable
+{
+public:
+    typedef shared_ptr<SupportTable> Ptr;
+
+    SupportTable();
+
+    /**
+     * Get the table of an ontology, a table is created on first access
+     */
+    static SupportTable::Ptr getInstance(const owlapi::model::OWLOntology::Ptr& ontology);
+
+    /**
+     * Drop the table of an ontology
+     */
+    static void clear(const owlapi::model::OWLOntology::Ptr& ontology);
+
+    /**
+     * Lookup the support of a service model
+     * \param providerModels The combination of provider models, where the
+     * order does not matter
+     * \param supporting Set to the stored result if an entry exists
+     * \return True if an entry exists, false otherwise
+     */
+    bool lookup(const owlapi::model::IRIList& providerModels,
+            const owlapi::model::IRI& serviceModel,
+            const owlapi::model::IRI& objectProperty,
+            bool& supporting) const;
+
+    /**
+     * Store the support of a service model
+     * \param providerModels The combination of provider models, where the
+     * order does not matter
+     */
+    void insert(const owlapi::model::IRIList& providerModels,
+            const owlapi::model::IRI& serviceModel,
+            const owlapi::model::IRI& objectProperty,
+            bool supporting);
+
+    /**
+     * Get the number of entries
+     */
+    size_t size() const;
+
+private:
+    typedef std::tuple<uint32_t, uint32_t, uint32_t> Key;
+
+    /**
+     * Find the ids of existing models without interning them
+     * \return False if any of the ids does not exist
+     */
+    bool findKey(const owlapi::model::IRIList& providerModels,
+            const owlapi::model::IRI& serviceModel,
+            const owlapi::model::IRI& objectProperty,
+            Key& key) const;
+
+    uint32_t intern(const owlapi::model::IRI& iri);
+
+    mutable boost::shared_mutex mMutex;
+    /// Ids of service models and properties
+    std::map<owlapi::model::IRI, uint32_t> mIds;
+    /// Ids of the (sorted) combinations of provider models
+    std::map<owlapi::model::IRIList, uint32_t> mProviderIds;
+    std::map<Key, bool> mEntries;
+
+    /// The ontology the table belongs to, used to detect a table that
+    /// outlived its ontology
+    std::weak_ptr<owlapi::model::OWLOntology> mOntology;
+
+    static boost::mutex msTablesMutex;
+    static std::map<const owlapi::model::OWLOntology*, SupportTable::Ptr> msTables;
+};
+
+} // end namespace reasoning
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_REASONING_SUPPORT_TABLE_HPP
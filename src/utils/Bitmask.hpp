@@ -0,0 +1,127 @@
+#ifndef ORGANIZATION_MODEL_UTILS_BITMASK_HPP
+#define ORGANIZATION_MODEL_UTILS_BITMASK_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace moreorg {
+namespace utils {
+
+/**
+ * A subset of at most 64 items, where bit i represents the i-th item of
+ * a reference list
+ */
+typedef uint64_t Bitmask;
+
+namespace bitmask {
+
+/**
+ * Maximum number of items a bitmask can represent
+ */
+const size_t MAX_SIZE = 64;
+
+/**
+ * Get the number of items in the set
+ */
+inline size_t count(Bitmask mask)
+{
+    return __builtin_popcountll(mask);
+}
+
+/**
+ * Get the index of the lowest item in a non-empty set
+ */
+inline size_t lowest(Bitmask mask)
+{
+    return __builtin_ctzll(mask);
+}
+
+/**
+ * Get the set of the first k items
+ */
+inline Bitmask first(size_t k)
+{
+    return k >= MAX_SIZE ? ~Bitmask(0) : (Bitmask(1) << k) - 1;
+}
+
+/**
+ * Get the next larger set with the same number of items (Gosper's hack),
+ * i.e. starting from first(k) all subsets of size k of the first n items
+ * are enumerated in colexicographic order, while the result is smaller than
+ * Bitmask(1) << n
+ * \param mask a non-empty set
+ */
+inline Bitmask next(Bitmask mask)
+{
+    Bitmask lowestBit = mask & (~mask + 1);
+    Bitmask ripple = mask + lowestBit;
+    return (((ripple ^ mask) >> 2) / lowestBit) | ripple;
+}
+
+/**
+ * Map a subset of the items of a set onto the set, i.e. bit i of compact
+ * selects the i-th lowest item of set
+ * \param compact a subset of the first count(set) items
+ * \param set the set to select the items from
+ */
+inline Bitmask deposit(Bitmask compact, Bitmask set)
+{
+    Bitmask result = 0;
+    for(; compact && set; compact >>= 1)
+    {
+        Bitmask item = set & (~set + 1);
+        if(compact & 1)
+        {
+            result |= item;
+        }
+        set ^= item;
+    }
+    return result;
+}
+
+/**
+ * Get the items of a set
+ * \param mask the set
+ * \param items the reference list of items
+ */
+template<typename T>
+std::vector<T> toList(Bitmask mask, const std::vector<T>& items)
+{
+    std::vector<T> list;
+    list.reserve(count(mask));
+    for(; mask; mask &= mask - 1)
+    {
+        list.push_back( items[lowest(mask)] );
+    }
+    return list;
+}
+
+/**
+ * Get the set of a list of items
+ * \param list the items of the set
+ * \param items the reference list of items
+ * \throws std::invalid_argument if an item is not part of the reference list
+ */
+template<typename T>
+Bitmask fromList(const std::vector<T>& list, const std::vector<T>& items)
+{
+    Bitmask mask = 0;
+    for(const T& item : list)
+    {
+        typename std::vector<T>::const_iterator cit = std::find(items.begin(), items.end(), item);
+        if(cit == items.end() || cit - items.begin() >= (int) MAX_SIZE)
+        {
+            throw std::invalid_argument("moreorg::utils::bitmask::fromList: item is not part of the reference list");
+        }
+        mask |= Bitmask(1) << (cit - items.begin());
+    }
+    return mask;
+}
+
+} // end namespace bitmask
+} // end namespace utils
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_UTILS_BITMASK_HPP
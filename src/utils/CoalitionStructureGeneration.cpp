@@ -1,7 +1,8 @@
 #include "CoalitionStructureGeneration.hpp"
-#include <numeric/Combinatorics.hpp>
+#include <atomic>
 
 using namespace numeric;
+namespace bitmask = moreorg::utils::bitmask;
 
 namespace multiagent {
 namespace utils {
@@ -107,39 +108,40 @@ CoalitionStructureGeneration::CoalitionStructureGeneration(const AgentList& agen
     , mCoalitionValueFunction(coalitionValueFunction)
     , mCoalitionStructureValueFunction(coalitionStructureValueFunction)
 {
+    if(agents.size() >= bitmask::MAX_SIZE)
+    {
+        std::stringstream ss;
+        ss << "multiagent::utils::CoalitionStructureGeneration: at most " << bitmask::MAX_SIZE - 1 << " agents are supported, got " << agents.size();
+        throw std::invalid_argument(ss.str());
+    }
     reset();
 }
 
 void CoalitionStructureGeneration::prepare()
 {
-    using namespace numeric;
-    Combination<std::string> combinations(mAgents, mAgents.size(), MAX);
-    do {
-
-        std::vector<std::string> coalition = combinations.current();
-        mAgentCoalitionMap[coalition.size()].insert(coalition);
-    } while(combinations.next());
-
+    size_t numberOfAgents = mAgents.size();
+    Bitmask end = Bitmask(1) << numberOfAgents;
+    mCoalitionValues.assign(end, 0.0);
+    mCoalitionBoundMap.clear();
+    mIntegerPartitionBoundsMap.clear();
 
     // Compute bounds for coalitions a given size, e.g.
     // coalition of size 1: max 100, min 10, average 50
     // coalition of size 2: max 200, min 24, average 54
-    AgentCoalitionMap::const_iterator ait = mAgentCoalitionMap.begin();
-    for(; ait != mAgentCoalitionMap.end(); ++ait)
+    for(size_t coalitionSize = 1; coalitionSize <= numberOfAgents; ++coalitionSize)
     {
         Bounds bounds;
-        const std::set< Coalition >& coalitions = ait->second;
-
-        std::set<Coalition>::const_iterator cit = coalitions.begin();
         double sum = 0.0;
-        for(;  cit != coalitions.end(); ++cit)
+        size_t numberOfCoalitions = 0;
+        for(Bitmask coalition = bitmask::first(coalitionSize); coalition < end; coalition = bitmask::next(coalition))
         {
-            const Coalition& coalition = *cit;
-            double value = mCoalitionValueFunction(coalition);
+            double value = mCoalitionValueFunction( bitmask::toList(coalition, mAgents) );
+            mCoalitionValues[coalition] = value;
 
             LOG_DEBUG_S << "Coalition value: " << value;
 
             sum += value;
+            ++numberOfCoalitions;
             if(value > bounds.maximum)
             {
                 bounds.maximum = value;
@@ -149,9 +151,7 @@ void CoalitionStructureGeneration::prepare()
                 bounds.minimum = value;
             }
         }
-        bounds.average = sum / coalitions.size();
-
-        size_t coalitionSize = ait->first;
+        bounds.average = sum / numberOfCoalitions;
         mCoalitionBoundMap[coalitionSize] = bounds;
     }
 
@@ -334,7 +334,9 @@ CoalitionStructure CoalitionStructureGeneration::findBest(double quality)
             boost::unique_lock<boost::mutex> lock(mStatisticsMutex);
             mStatistics.searchedIntegerPartitions.push_back(partition);
         }
-        bool improvedResult = searchSubspace(partition, 0, 0, mAgents, CoalitionStructure(), quality);
+        std::vector<Bitmask> coalitionStructure;
+        coalitionStructure.reserve(partition.size());
+        bool improvedResult = searchSubspace(partition, 0, 0, bitmask::first(mAgents.size()), coalitionStructure, 0.0, quality);
 
         // No improvement of the results
         if(!improvedResult)
@@ -371,6 +373,140 @@ CoalitionStructure CoalitionStructureGeneration::findBest(double quality)
     return currentBestSolution();
 }
 
+CoalitionStructure CoalitionStructureGeneration::findBestDP(size_t numberOfThreads)
+{
+    size_t numberOfAgents = mAgents.size();
+    if(numberOfAgents > MAX_DP_AGENTS)
+    {
+        std::stringstream ss;
+        ss << "multiagent::utils::CoalitionStructureGeneration::findBestDP: at most " << MAX_DP_AGENTS << " agents are supported, got " << numberOfAgents;
+        throw std::invalid_argument(ss.str());
+    }
+    if(numberOfThreads == 0)
+    {
+        numberOfThreads = std::max(1u, boost::thread::hardware_concurrency());
+    }
+
+    mStartTime = base::Time::now();
+    mCompletionTime = base::Time();
+
+    // Coalitions grouped by size, since the values of coalitions of one size
+    // depend on the values of smaller coalitions only
+    Bitmask end = Bitmask(1) << numberOfAgents;
+    std::vector< std::vector<Bitmask> > coalitionsBySize(numberOfAgents + 1);
+    for(size_t coalitionSize = 1; coalitionSize <= numberOfAgents; ++coalitionSize)
+    {
+        std::vector<Bitmask>& coalitions = coalitionsBySize[coalitionSize];
+        for(Bitmask coalition = bitmask::first(coalitionSize); coalition < end; coalition = bitmask::next(coalition))
+        {
+            coalitions.push_back(coalition);
+        }
+    }
+
+    std::vector<double> values = mCoalitionValues;
+    std::vector<Bitmask> splits(end);
+    for(Bitmask coalition = 0; coalition < end; ++coalition)
+    {
+        splits[coalition] = coalition;
+    }
+
+    std::vector< std::atomic<size_t> > next(numberOfAgents + 1);
+    for(std::atomic<size_t>& n : next)
+    {
+        n = 0;
+    }
+    boost::barrier barrier(numberOfThreads);
+    auto fillTable = [&coalitionsBySize, &values, &splits, &next, &barrier, numberOfAgents]()
+    {
+        for(size_t coalitionSize = 2; coalitionSize <= numberOfAgents; ++coalitionSize)
+        {
+            const std::vector<Bitmask>& coalitions = coalitionsBySize[coalitionSize];
+            for(size_t i = next[coalitionSize]++; i < coalitions.size(); i = next[coalitionSize]++)
+            {
+                evaluateSplits(coalitions[i], values, splits);
+            }
+            barrier.wait();
+        }
+    };
+
+    if(numberOfThreads == 1)
+    {
+        fillTable();
+    } else {
+        boost::thread_group workers;
+        for(size_t i = 0; i < numberOfThreads; ++i)
+        {
+            workers.create_thread(fillTable);
+        }
+        workers.join_all();
+    }
+
+    // Follow the splits starting from the grand coalition
+    std::vector<Bitmask> structure;
+    std::vector<Bitmask> open;
+    if(end > 1)
+    {
+        open.push_back(end - 1);
+    }
+    while(!open.empty())
+    {
+        Bitmask coalition = open.back();
+        open.pop_back();
+        Bitmask first = splits[coalition];
+        if(first == coalition)
+        {
+            structure.push_back(coalition);
+        } else {
+            open.push_back(first);
+            open.push_back(coalition ^ first);
+        }
+    }
+
+    CoalitionStructure coalitionStructure = toCoalitionStructure(structure);
+    double coalitionStructureValue = mCoalitionStructureValueFunction(coalitionStructure);
+    LOG_DEBUG_S << "Optimal coalition structure: " << coalitionStructure << ", value " << coalitionStructureValue;
+    updateCurrentBestCoalitionStructure(coalitionStructure, coalitionStructureValue);
+    mGlobalUpperBound = values[end - 1];
+    mCompletionTime = base::Time::now();
+
+    return currentBestSolution();
+}
+
+void CoalitionStructureGeneration::evaluateSplits(Bitmask coalition, std::vector<double>& values, std::vector<Bitmask>& splits)
+{
+    // Each split into two non-empty coalitions is evaluated only once,
+    // by keeping the lowest agent in the first coalition
+    Bitmask lowest = coalition & (~coalition + 1);
+    Bitmask rest = coalition ^ lowest;
+    double bestValue = values[coalition];
+    Bitmask bestSplit = coalition;
+    for(Bitmask subset = (rest - 1) & rest; rest != 0; subset = (subset - 1) & rest)
+    {
+        Bitmask first = lowest | subset;
+        double value = values[first] + values[coalition ^ first];
+        if(value > bestValue)
+        {
+            bestValue = value;
+            bestSplit = first;
+        }
+        if(subset == 0)
+        {
+            break;
+        }
+    }
+    values[coalition] = bestValue;
+    splits[coalition] = bestSplit;
+}
+
+CoalitionStructure CoalitionStructureGeneration::findOptimal(size_t numberOfThreads)
+{
+    if(mAgents.size() <= MAX_DP_AGENTS)
+    {
+        return findBestDP(numberOfThreads);
+    }
+    return findBest(1.0);
+}
+
 void CoalitionStructureGeneration::anytimeSearch(double quality)
 {
     mStartTime = base::Time::now();
@@ -442,12 +578,12 @@ IntegerPartition CoalitionStructureGeneration::selectIntegerPartition(const Coal
  * \param globalUpperBound
  * \param bestStar Quality of the solution, i.e. 1.05 means 95% percent of the optimal solution
  */
-bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partition, size_t k, size_t alpha, const AgentList& agents, const CoalitionStructure& currentStructure, double betaStar)
+bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partition, size_t k, size_t alpha, Bitmask agents, std::vector<Bitmask>& currentStructure, double currentStructureValue, double betaStar)
 {
     bool improvedResult = false;
 
     std::string indent(4*k, ' ');
-    LOG_DEBUG_S << indent << " search subspace of current structure: " << currentStructure;
+    LOG_DEBUG_S << indent << " search subspace of current structure with " << currentStructure.size() << " coalitions, value: " << currentStructureValue;
 
     if(k > 0 && partition[k] != partition[k-1])
     {
@@ -456,13 +592,8 @@ bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partit
         alpha = 1;
     }
 
-    // Initialize index list
-    std::vector<int> indexList;
-    for(size_t i = 0; i < agents.size(); ++i)
-    {
-        indexList.push_back(i);
-    }
-    LOG_DEBUG_S << indent << " indexlist initialized: " << IntegerPartitioning::toString(indexList) << " agents: " << agents.size();
+    size_t numberOfAgents = bitmask::count(agents);
+    LOG_DEBUG_S << indent << " remaining agents: " << numberOfAgents;
 
     // Compute upper bound for M_{k,0} to avoid redundant computations
     int upperBoundM_k = mAgents.size() + 1;
@@ -477,64 +608,44 @@ bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partit
     double upperBoundOfSubspace = mIntegerPartitionBoundsMap[partition].maximum;
     LOG_DEBUG_S << indent << " upperBound of subspace " << IntegerPartitioning::toString(partition) << ": " << upperBoundOfSubspace;
 
-    using namespace numeric;
-    Combination<int> combinations(indexList, partition[k], EXACT);
-    do {
-        // m_k represent the an array of indices
-        std::vector<int> m_k = combinations.current();
-        LOG_DEBUG_S << indent << " current combination m_k=" << IntegerPartitioning::toString(m_k) << ", alpha=" << alpha;
-        // m_k[0] + 1: we start with index 0, but the algorithmic description uses 1 as first index
-        if(((int) alpha) <= m_k[0] + 1 && m_k[0] + 1 <= upperBoundM_k)
+    // m_k is enumerated as bitmask over the indices of the remaining agents,
+    // i.e. bit i refers to the i-th remaining agent
+    Bitmask end = Bitmask(1) << numberOfAgents;
+    for(Bitmask m_k = bitmask::first(partition[k]); m_k < end; m_k = bitmask::next(m_k))
+    {
+        int m_k0 = bitmask::lowest(m_k);
+        LOG_DEBUG_S << indent << " current combination m_k=" << m_k << ", alpha=" << alpha;
+        // m_k0 + 1: we start with index 0, but the algorithmic description uses 1 as first index
+        if(((int) alpha) <= m_k0 + 1 && m_k0 + 1 <= upperBoundM_k)
         {
-            LOG_DEBUG_S << indent << " computing combination";
             // Map combination of indices to current coalition, i.e. an agent (sub)set
-            AgentList remainingAgents = agents;
-            std::vector<Agent> coalition;
-            for(size_t i = 0; i < m_k.size(); ++i)
-            {
-                Agent agent = agents[ m_k[i] ];
-                coalition.push_back(agent);
-                std::vector<Agent>::iterator it = std::find(remainingAgents.begin(), remainingAgents.end(), agent);
-                remainingAgents.erase(it);
-            }
-            CoalitionStructure coalitionStructure = currentStructure;
-            coalitionStructure.push_back(coalition);
-
-            LOG_DEBUG_S << indent << " current coalition structure: " << currentStructure;
-            LOG_DEBUG_S << indent << " partial coalition structure: " << coalitionStructure << " , remaining agents " << remainingAgents;
-
+            Bitmask coalition = bitmask::deposit(m_k, agents);
+            double structureValue = currentStructureValue + mCoalitionValues[coalition];
+            currentStructure.push_back(coalition);
 
             // Check if we reached the end, i.e. when we have a complete coalition structure
             if(k == partition.size() - 1)
             {
-                double currentStructureValue = mCoalitionStructureValueFunction( coalitionStructure );
-                LOG_DEBUG_S << indent << " reached the end at k: " << k << " -- bestValue: " << currentBestSolution() << " vs. " << currentStructureValue;
-                if(currentStructureValue > currentBestSolutionValue())
+                CoalitionStructure coalitionStructure = toCoalitionStructure(currentStructure);
+                double coalitionStructureValue = mCoalitionStructureValueFunction( coalitionStructure );
+                LOG_DEBUG_S << indent << " reached the end at k: " << k << " -- bestValue: " << currentBestSolutionValue() << " vs. " << coalitionStructureValue;
+                if(coalitionStructureValue > currentBestSolutionValue())
                 {
                     // update the currently best coalition structure
-                    LOG_DEBUG_S << indent << " update global best: " << currentBestSolution() << ", value " << currentBestSolutionValue();
-                    improvedResult = updateCurrentBestCoalitionStructure(coalitionStructure, currentStructureValue) || improvedResult;
+                    LOG_DEBUG_S << indent << " update global best: " << coalitionStructure << ", value " << coalitionStructureValue;
+                    improvedResult = updateCurrentBestCoalitionStructure(coalitionStructure, coalitionStructureValue) || improvedResult;
                 }
             } else {
-                LOG_DEBUG_S << indent << " computing subspace potential";
                 // Estimate the potential of this subspace using
                 // know value for the already found coalitions
                 // and existing upper bounds for the coalitions still
                 // to look at
-                double subspacePotentialValue = 0;
-
-                // Estimate value of current (partial) coalition structure
-                for( size_t i = 0; i < coalitionStructure.size(); ++i)
-                {
-                    double valueOfCoalition = mCoalitionValueFunction( coalitionStructure[i] );
-                    LOG_DEBUG_S << indent << " coalition: " << coalitionStructure[i] << " value: " << valueOfCoalition;
-                    subspacePotentialValue += valueOfCoalition;
-                }
+                double subspacePotentialValue = structureValue;
 
                 // Estimate value for the rest of the partition based on the bounds computed
                 // on coalition sizes, i.e.
                 // looking at the integer partition's yet uninvestigated range
-                for( size_t i = coalitionStructure.size(); i < partition.size(); ++i)
+                for( size_t i = currentStructure.size(); i < partition.size(); ++i)
                 {
                     double max_s = mCoalitionBoundMap[ partition[i] ].maximum;
                     LOG_DEBUG_S << indent << " potential for coalition size: " << partition[i] << ": " << max_s;
@@ -546,7 +657,7 @@ bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partit
                 if(currentBestSolutionValue() < subspacePotentialValue)
                 {
                     LOG_DEBUG_S << indent << " continue search: best: " << currentBestSolutionValue() << " vs. subspace potential: " <<  subspacePotentialValue;
-                    if( searchSubspace(partition, k+1, m_k[0], remainingAgents, coalitionStructure, betaStar) )
+                    if( searchSubspace(partition, k+1, m_k0, agents & ~coalition, currentStructure, structureValue, betaStar) )
                     {
                         improvedResult = true;
                     }
@@ -554,6 +665,7 @@ bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partit
                     LOG_DEBUG_S << indent << " pruning: insufficient subspace potential: best: " << currentBestSolutionValue() << " vs. " <<  subspacePotentialValue;
                 }
             }
+            currentStructure.pop_back();
 
             // Stop if the required solution has been found or if the current best
             // is equal to the upper bound of this sub-space
@@ -572,15 +684,25 @@ bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partit
                 return improvedResult;
             }
         } else {
-        // if(alpha <= m_k[0] && m_k[0] <= upperBoundM_k)
             LOG_DEBUG_S << indent << " skipping: condition does not hold: alpha < m_k[0]+1 && m_k[0]+1 <= upperBoundM_k"
-                << ", alpha= " << alpha << ", m_k[0]=" << m_k[0] << ", upperBoundM_k=" << upperBoundM_k;
+                << ", alpha= " << alpha << ", m_k[0]=" << m_k0 << ", upperBoundM_k=" << upperBoundM_k;
         }
-    } while(combinations.next());
+    }
 
     return improvedResult;
 }
 
+CoalitionStructure CoalitionStructureGeneration::toCoalitionStructure(const std::vector<Bitmask>& structure) const
+{
+    CoalitionStructure coalitionStructure;
+    coalitionStructure.reserve(structure.size());
+    for(Bitmask coalition : structure)
+    {
+        coalitionStructure.push_back( bitmask::toList(coalition, mAgents) );
+    }
+    return coalitionStructure;
+}
+
 bool CoalitionStructureGeneration::updateCurrentBestCoalitionStructure(const CoalitionStructure& coalitionStructure, double value)
 {
     boost::unique_lock<boost::mutex> lock(mSolutionMutex);
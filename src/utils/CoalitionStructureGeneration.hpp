@@ -7,6 +7,7 @@
 #include <numeric/IntegerPartitioning.hpp>
 #include <base/Time.hpp>
 #include <base-logging/Logging.hpp>
+#include "Bitmask.hpp"
 
 namespace multiagent {
 namespace utils {
@@ -38,11 +39,24 @@ std::ostream& operator<<(std::ostream& os, const Bounds& bounds);
  * This is an implementation of the coalition structure generation as described in:
  * "An Anytime Algorithm for Optimal Coalition Structure Generation", (Rahwan et al., 2009)
  *
- * Please note that the current implementation uses recursion
+ * Internally coalitions are represented as bitmasks over the list of agents,
+ * so that at most 63 agents are supported. The values of all coalitions are
+ * computed once and stored in a table indexed by bitmask. Agent lists are only
+ * created to evaluate the coalition (structure) value functions and to return results.
+ *
+ * For small numbers of agents findBestDP computes the optimal coalition
+ * structure by dynamic programming over all subsets of agents, which
+ * is typically much faster than the anytime search of findBest.
+ * findOptimal selects the solver depending on the number of agents.
+ *
+ * Please note that the current implementation of findBest uses recursion
  */
 class CoalitionStructureGeneration
 {
 public:
+    /// Maximum number of agents to use findBestDP for
+    enum { MAX_DP_AGENTS = 20 };
+
     typedef boost::function1<double, const Coalition&> CoalitionValueFunction;
     typedef boost::function1<double, const CoalitionStructure&> CoalitionStructureValueFunction;
 
@@ -61,9 +75,10 @@ private:
     AgentList mAgents;
     Statistics mStatistics;
 
-    // Agents listed by size of the coalition
-    typedef std::map<size_t, std::set< Coalition > > AgentCoalitionMap;
-    AgentCoalitionMap mAgentCoalitionMap;
+    typedef moreorg::utils::Bitmask Bitmask;
+
+    /// Values of all coalitions, indexed by the bitmask of the coalition
+    std::vector<double> mCoalitionValues;
 
     typedef std::map<size_t, Bounds> CoalitionBoundMap;
     CoalitionBoundMap mCoalitionBoundMap;
@@ -85,7 +100,7 @@ private:
     double mGlobalUpperBound;
 
     /**
-     * Compute the integer partitions and the agent coalition map for coalition size up to
+     * Compute the integer partitions and the coalition values for coalition size up to
      * the maximum number of agents
      */
     void prepare();
@@ -102,20 +117,58 @@ private:
 
     /**
      *
-     * \param globalUpperBound
+     * \param agents Agents which remain to be assigned
+     * \param currentStructure The coalitions selected so far, the
+     * coalitions of deeper levels are removed again before returning
+     * \param currentStructureValue The sum of the values of currentStructure
      * \param bestStar Quality of the solution, i.e. 1.05 means 95% percent of the optimal solution
      * \return true if this subspace contained a better solution than already existed
      */
-    bool searchSubspace(const numeric::IntegerPartition& partition, size_t k, size_t alpha, const AgentList& agents, const CoalitionStructure& currentStructure, double betaStar);
+    bool searchSubspace(const numeric::IntegerPartition& partition, size_t k, size_t alpha, Bitmask agents, std::vector<Bitmask>& currentStructure, double currentStructureValue, double betaStar);
+
+    /**
+     * Map coalitions from bitmasks to agent lists
+     */
+    CoalitionStructure toCoalitionStructure(const std::vector<Bitmask>& structure) const;
 
     bool updateCurrentBestCoalitionStructure(const CoalitionStructure& coalitionStructure, double value);
 
+    /**
+     * Compute the best split of a coalition into two coalitions, given
+     * the values of all smaller coalitions
+     * \param values Best values of the coalition structures over the agents
+     * of a coalition
+     * \param splits First coalition of the best split, or the coalition itself
+     * if the coalition should not be split
+     */
+    static void evaluateSplits(Bitmask coalition, std::vector<double>& values, std::vector<Bitmask>& splits);
+
 public:
     /**
      * Find best coalitionstructure -- will block until coalition structure is found
      */ 
     CoalitionStructure findBest(double quality = 1.0);
 
+    /**
+     * Find the optimal coalition structure using dynamic programming over
+     * all subsets of agents -- will block until the coalition structure is found
+     *
+     * The value of a coalition structure is assumed to be the sum of the
+     * values of its coalitions (as for the bounds used by findBest).
+     * Coalitions of the same size are evaluated in parallel
+     * \param numberOfThreads Number of threads to use, 0 to use one thread per core
+     * \throws std::invalid_argument if more than MAX_DP_AGENTS agents are given
+     */
+    CoalitionStructure findBestDP(size_t numberOfThreads = 0);
+
+    /**
+     * Find the optimal coalition structure, using findBestDP for at most
+     * MAX_DP_AGENTS agents and findBest otherwise
+     * \param numberOfThreads Number of threads for findBestDP, 0 to use one
+     * thread per core
+     */
+    CoalitionStructure findOptimal(size_t numberOfThreads = 0);
+
     /**
      * Reset in order to restart a new search
      */
@@ -155,6 +208,7 @@ public:
 
     /**
      * \params agents List of agents that are available
+     * \throws std::invalid_argument if more than 63 agents are given
      * \param coalitionValueFunction Function that allows to compute the value of an individual coalition
      * \param coalitionStructureValueFunction Function that allows to compute the value of a coalition structure
      */
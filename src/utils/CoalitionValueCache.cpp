@@ -0,0 +1,133 @@
+#include "CoalitionValueCache.hpp"
+#include <algorithm>
+#include <boost/thread.hpp>
+#include <numeric/LimitedCombination.hpp>
+
+namespace moreorg {
+namespace utils {
+
+CoalitionValueCache::CoalitionValueCache(CoalitionValueFunction coalitionValueFunction, size_t maxSize)
+    : mCoalitionValueFunction(coalitionValueFunction)
+    , mMaxSize(maxSize)
+    , mHits(0)
+    , mMisses(0)
+{}
+
+double CoalitionValueCache::getValue(const AtomicAgent::List& coalition)
+{
+    // Avoid copying the coalition when it is already sorted
+    AtomicAgent::List sortedCoalition;
+    bool sorted = std::is_sorted(coalition.begin(), coalition.end());
+    if(!sorted)
+    {
+        sortedCoalition = coalition;
+        std::sort(sortedCoalition.begin(), sortedCoalition.end());
+    }
+    const AtomicAgent::List& key = sorted ? coalition : sortedCoalition;
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mMutex);
+        std::map<AtomicAgent::List, double>::const_iterator cit = mValues.find(key);
+        if(cit != mValues.end())
+        {
+            ++mHits;
+            return cit->second;
+        }
+    }
+
+    // Compute without holding the lock, since the computation might take
+    // long -- concurrent misses for the same coalition compute the same value
+    ++mMisses;
+    double value = mCoalitionValueFunction(coalition);
+    insert(key, value);
+    return value;
+}
+
+bool CoalitionValueCache::lookup(const AtomicAgent::List& coalition, double& value) const
+{
+    AtomicAgent::List key = coalition;
+    std::sort(key.begin(), key.end());
+
+    boost::shared_lock<boost::shared_mutex> lock(mMutex);
+    std::map<AtomicAgent::List, double>::const_iterator cit = mValues.find(key);
+    if(cit == mValues.end())
+    {
+        return false;
+    }
+    value = cit->second;
+    return true;
+}
+
+void CoalitionValueCache::precompute(const AtomicAgent::List& agents, size_t maxCoalitionSize, size_t numberOfThreads)
+{
+    maxCoalitionSize = std::min(maxCoalitionSize, agents.size());
+    if(maxCoalitionSize == 0)
+    {
+        return;
+    }
+
+    std::vector<AtomicAgent::List> coalitions;
+    ModelPool modelPool = AtomicAgent::getModelPool(agents);
+    numeric::LimitedCombination<owlapi::model::IRI> combinations(modelPool, maxCoalitionSize, numeric::MAX);
+    do {
+        ModelPool m(combinations.current());
+        coalitions.push_back( AtomicAgent::toList(m) );
+    } while(combinations.next());
+
+    if(numberOfThreads == 0)
+    {
+        numberOfThreads = std::max(1u, boost::thread::hardware_concurrency());
+    }
+    numberOfThreads = std::min(numberOfThreads, coalitions.size());
+
+    std::atomic<size_t> next(0);
+    boost::thread_group workers;
+    for(size_t i = 0; i < numberOfThreads; ++i)
+    {
+        workers.create_thread([this, &coalitions, &next]()
+                {
+                    for(size_t c = next++; c < coalitions.size(); c = next++)
+                    {
+                        getValue(coalitions[c]);
+                    }
+                });
+    }
+    workers.join_all();
+}
+
+void CoalitionValueCache::clear()
+{
+    boost::unique_lock<boost::shared_mutex> lock(mMutex);
+    mValues.clear();
+    mInsertionOrder.clear();
+    mHits = 0;
+    mMisses = 0;
+}
+
+size_t CoalitionValueCache::size() const
+{
+    boost::shared_lock<boost::shared_mutex> lock(mMutex);
+    return mValues.size();
+}
+
+void CoalitionValueCache::insert(const AtomicAgent::List& key, double value)
+{
+    boost::unique_lock<boost::shared_mutex> lock(mMutex);
+    if(!mValues.insert( std::make_pair(key, value) ).second)
+    {
+        // already added by a concurrent miss
+        return;
+    }
+
+    if(mMaxSize != 0)
+    {
+        mInsertionOrder.push_back(key);
+        while(mValues.size() > mMaxSize)
+        {
+            mValues.erase( mInsertionOrder.front() );
+            mInsertionOrder.pop_front();
+        }
+    }
+}
+
+} // end namespace utils
+} // end namespace moreorg
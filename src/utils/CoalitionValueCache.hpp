@@ -0,0 +1,110 @@
+#ifndef ORGANIZATION_MODEL_UTILS_COALITION_VALUE_CACHE_HPP
+#define ORGANIZATION_MODEL_UTILS_COALITION_VALUE_CACHE_HPP
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <boost/function.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include "../AtomicAgent.hpp"
+#include "../SharedPtr.hpp"
+
+namespace moreorg {
+namespace utils {
+
+/**
+ * \class CoalitionValueCache
+ * \brief Memo cache for the values of coalitions
+ *
+ * \details
+ * The value of a coalition is computed once by the value function and stored
+ * under the sorted list of its agents, so that the order of agents in a
+ * coalition does not matter.
+ * Lookups can be performed concurrently, the value function however is called
+ * without locking and thus has to be thread-safe when the cache is shared
+ * between threads.
+ *
+ * If a maximum size is set, the oldest entries are dropped first
+ \verbatim
+    CoalitionValueCache::Ptr cache = make_shared<CoalitionValueCache>(valueFunction);
+    cache->precompute(agents, 2, 4);
+    double value = cache->getValue(coalition);
+ \endverbatim
+ */
+class CoalitionValueCache
+{
+public:
+    typedef shared_ptr<CoalitionValueCache> Ptr;
+    typedef boost::function1<double, const AtomicAgent::List&> CoalitionValueFunction;
+
+    /**
+     * \param coalitionValueFunction Function to compute the value of a coalition
+     * \param maxSize Maximum number of entries, 0 for no limit
+     */
+    CoalitionValueCache(CoalitionValueFunction coalitionValueFunction, size_t maxSize = 0);
+
+    /**
+     * Get the value of a coalition, the value is computed if it has not
+     * been cached
+     */
+    double getValue(const AtomicAgent::List& coalition);
+
+    /**
+     * Lookup the value of a coalition without computing it
+     * \return True if an entry exists, false otherwise
+     */
+    bool lookup(const AtomicAgent::List& coalition, double& value) const;
+
+    /**
+     * Compute the values of all coalitions up to a given size
+     * The coalitions are enumerated per combination of agent models, as done by
+     * CoalitionStructureGeneration, i.e. using the agents of
+     * AtomicAgent::toList for each combination
+     * \param agents Agents to form coalitions of
+     * \param maxCoalitionSize Maximum size of the coalitions
+     * \param numberOfThreads Number of threads to evaluate the value function
+     * with, 0 to use one thread per core
+     */
+    void precompute(const AtomicAgent::List& agents, size_t maxCoalitionSize, size_t numberOfThreads = 0);
+
+    /**
+     * Drop all entries and reset the statistics
+     */
+    void clear();
+
+    /**
+     * Get the number of entries
+     */
+    size_t size() const;
+
+    size_t getMaxSize() const { return mMaxSize; }
+
+    /**
+     * Get the number of calls to getValue that have been answered from the
+     * cache
+     */
+    size_t getHits() const { return mHits; }
+
+    /**
+     * Get the number of calls to getValue that required to compute the value
+     */
+    size_t getMisses() const { return mMisses; }
+
+private:
+    void insert(const AtomicAgent::List& key, double value);
+
+    CoalitionValueFunction mCoalitionValueFunction;
+    size_t mMaxSize;
+
+    mutable boost::shared_mutex mMutex;
+    std::map<AtomicAgent::List, double> mValues;
+    /// Keys in order of insertion to drop the oldest entries
+    std::deque<AtomicAgent::List> mInsertionOrder;
+
+    std::atomic<size_t> mHits;
+    std::atomic<size_t> mMisses;
+};
+
+} // end namespace utils
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_UTILS_COALITION_VALUE_CACHE_HPP
@@ -52,6 +52,7 @@ std::map<Gecode::IntVarBranch::Select, std::string> GecodeUtils::IntVarSelect2Tx
     { Gecode::IntVarBranch::SEL_REGRET_MAX_MAX, "REGRET_MAX_MAX" }
 };
 
+std::vector<std::string> GecodeUtils::CutoffTypes = { "CONSTANT", "GEOMETRIC", "LUBY" };
 
 Gecode::IntValBranch::Select GecodeUtils::getIntValSelect(const std::string& txt)
 {
@@ -77,5 +78,20 @@ Gecode::IntVarBranch::Select GecodeUtils::getIntVarSelect(const std::string& txt
     throw std::invalid_argument("moreorg::utils::GecodeUtils::getIntVarSelect: could not find value for '" + txt + "'");
 }
 
+Gecode::Search::Cutoff* GecodeUtils::getCutoff(const std::string& txt, unsigned long scale)
+{
+    if(txt == "CONSTANT")
+    {
+        return Gecode::Search::Cutoff::constant(scale);
+    } else if(txt == "GEOMETRIC")
+    {
+        return Gecode::Search::Cutoff::geometric(scale, 2);
+    } else if(txt == "LUBY")
+    {
+        return Gecode::Search::Cutoff::luby(scale);
+    }
+    throw std::invalid_argument("moreorg::utils::GecodeUtils::getCutoff: could not find cutoff for '" + txt + "'");
+}
+
 } // end namespace utils
 } // end namespace moreorg
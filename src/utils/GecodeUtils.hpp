@@ -1,5 +1,7 @@
 #include "gecode/int.hh"
+#include "gecode/search.hh"
 #include <map>
+#include <vector>
 
 namespace moreorg {
 namespace utils {
@@ -12,9 +14,19 @@ public:
     static std::map<Gecode::IntVarBranch::Select, std::string> IntVarSelect2Txt;
 
 
+    /// Names of the supported cutoffs (restart schedules) \see getCutoff
+    static std::vector<std::string> CutoffTypes;
+
     static Gecode::IntValBranch::Select getIntValSelect(const std::string& txt);
     static Gecode::IntVarBranch::Select getIntVarSelect(const std::string& txt);
 
+    /**
+     * Create the cutoff (restart schedule) for a restart-based search
+     * \param txt Type of the cutoff: CONSTANT, GEOMETRIC or LUBY
+     * \param scale Scale of the cutoff, i.e. number of failures
+     * \return Cutoff, which is owned by the caller
+     */
+    static Gecode::Search::Cutoff* getCutoff(const std::string& txt, unsigned long scale);
 
 };
 
@@ -0,0 +1,141 @@
+#include "MaxFlow.hpp"
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+namespace moreorg {
+namespace utils {
+
+MaxFlow::MaxFlow(size_t numberOfNodes)
+    : mAdjacency(numberOfNodes)
+{}
+
+size_t MaxFlow::addEdge(size_t from, size_t to, int64_t capacity)
+{
+    if(from >= mAdjacency.size() || to >= mAdjacency.size())
+    {
+        throw std::invalid_argument("moreorg::utils::MaxFlow::addEdge: node index out of range");
+    }
+    if(capacity < 0)
+    {
+        throw std::invalid_argument("moreorg::utils::MaxFlow::addEdge: negative capacity");
+    }
+
+    Edge forward = { to, capacity, 0 };
+    Edge reverse = { from, 0, 0 };
+    mAdjacency[from].push_back(mEdges.size());
+    mEdges.push_back(forward);
+    mAdjacency[to].push_back(mEdges.size());
+    mEdges.push_back(reverse);
+    return mEdges.size()/2 - 1;
+}
+
+void MaxFlow::setCapacity(size_t edge, int64_t capacity)
+{
+    if(2*edge >= mEdges.size())
+    {
+        throw std::invalid_argument("moreorg::utils::MaxFlow::setCapacity: edge index out of range");
+    }
+    if(capacity < 0)
+    {
+        throw std::invalid_argument("moreorg::utils::MaxFlow::setCapacity: negative capacity");
+    }
+    mEdges[2*edge].capacity = capacity;
+    for(Edge& e : mEdges)
+    {
+        e.flow = 0;
+    }
+}
+
+int64_t MaxFlow::solve(size_t source, size_t sink)
+{
+    if(source >= mAdjacency.size() || sink >= mAdjacency.size())
+    {
+        throw std::invalid_argument("moreorg::utils::MaxFlow::solve: node index out of range");
+    }
+
+    for(Edge& e : mEdges)
+    {
+        e.flow = 0;
+    }
+    if(source == sink)
+    {
+        return 0;
+    }
+
+    int64_t value = 0;
+    while(computeLevels(source, sink))
+    {
+        mNextEdge.assign(mAdjacency.size(), 0);
+        while(int64_t pushed = augment(source, sink, std::numeric_limits<int64_t>::max()))
+        {
+            value += pushed;
+        }
+    }
+    return value;
+}
+
+int64_t MaxFlow::getFlow(size_t edge) const
+{
+    if(2*edge >= mEdges.size())
+    {
+        throw std::invalid_argument("moreorg::utils::MaxFlow::getFlow: edge index out of range");
+    }
+    return mEdges[2*edge].flow;
+}
+
+bool MaxFlow::computeLevels(size_t source, size_t sink)
+{
+    mLevels.assign(mAdjacency.size(), -1);
+    mLevels[source] = 0;
+
+    std::deque<size_t> queue;
+    queue.push_back(source);
+    while(!queue.empty())
+    {
+        size_t node = queue.front();
+        queue.pop_front();
+        for(size_t index : mAdjacency[node])
+        {
+            const Edge& e = mEdges[index];
+            if(mLevels[e.to] < 0 && e.flow < e.capacity)
+            {
+                mLevels[e.to] = mLevels[node] + 1;
+                queue.push_back(e.to);
+            }
+        }
+    }
+    return mLevels[sink] >= 0;
+}
+
+int64_t MaxFlow::augment(size_t node, size_t sink, int64_t limit)
+{
+    if(node == sink)
+    {
+        return limit;
+    }
+
+    for(size_t& i = mNextEdge[node]; i < mAdjacency[node].size(); ++i)
+    {
+        size_t index = mAdjacency[node][i];
+        Edge& e = mEdges[index];
+        if(mLevels[e.to] != mLevels[node] + 1 || e.flow >= e.capacity)
+        {
+            continue;
+        }
+
+        int64_t pushed = augment(e.to, sink, std::min(limit, e.capacity - e.flow));
+        if(pushed > 0)
+        {
+            e.flow += pushed;
+            // the paired edge differs only in the lowest bit
+            mEdges[index ^ 1].flow -= pushed;
+            return pushed;
+        }
+    }
+    return 0;
+}
+
+} // end namespace utils
+} // end namespace moreorg
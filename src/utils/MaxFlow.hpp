@@ -0,0 +1,88 @@
+#ifndef ORGANIZATION_MODEL_UTILS_MAX_FLOW_HPP
+#define ORGANIZATION_MODEL_UTILS_MAX_FLOW_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace moreorg {
+namespace utils {
+
+/**
+ * \class MaxFlow
+ * \brief Integer maximum flow on a directed graph with capacitated edges
+ *
+ * \details
+ * The flow is computed using Dinic's algorithm, i.e. by repeatedly
+ * augmenting along blocking flows in the level graph of the residual network
+ \verbatim
+    MaxFlow flow(4);
+    size_t e = flow.addEdge(0, 1, 2);
+    flow.addEdge(1, 3, 2);
+    int64_t value = flow.solve(0, 3);
+    int64_t edgeFlow = flow.getFlow(e);
+ \endverbatim
+ */
+class MaxFlow
+{
+public:
+    /**
+     * Create a graph without edges
+     * \param numberOfNodes Number of nodes, indexed by [0,numberOfNodes)
+     */
+    explicit MaxFlow(size_t numberOfNodes);
+
+    /**
+     * Add a directed edge
+     * \param from Source node
+     * \param to Target node
+     * \param capacity Capacity of the edge
+     * \return index of the edge, to be used for getFlow
+     * \throws std::invalid_argument if a node is out of range or the capacity is negative
+     */
+    size_t addEdge(size_t from, size_t to, int64_t capacity);
+
+    /**
+     * Set the capacity of an existing edge and reset the flow
+     * \throws std::invalid_argument if the edge does not exist or the capacity is negative
+     */
+    void setCapacity(size_t edge, int64_t capacity);
+
+    /**
+     * Compute the maximum flow from source to sink
+     * Any existing flow is reset before the computation
+     * \return value of the maximum flow
+     */
+    int64_t solve(size_t source, size_t sink);
+
+    /**
+     * Get the flow along an edge after solve
+     */
+    int64_t getFlow(size_t edge) const;
+
+    size_t getNumberOfNodes() const { return mAdjacency.size(); }
+
+    size_t getNumberOfEdges() const { return mEdges.size() / 2; }
+
+private:
+    struct Edge
+    {
+        size_t to;
+        int64_t capacity;
+        int64_t flow;
+    };
+
+    bool computeLevels(size_t source, size_t sink);
+    int64_t augment(size_t node, size_t sink, int64_t limit);
+
+    /// Edges are stored pairwise: forward edge at 2*i, reverse edge at 2*i+1
+    std::vector<Edge> mEdges;
+    /// Indices of the outgoing (forward and reverse) edges per node
+    std::vector< std::vector<size_t> > mAdjacency;
+    std::vector<int> mLevels;
+    std::vector<size_t> mNextEdge;
+};
+
+} // end namespace utils
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_UTILS_MAX_FLOW_HPP
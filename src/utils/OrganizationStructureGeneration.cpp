@@ -1,4 +1,6 @@
 #include "OrganizationStructureGeneration.hpp"
+#include "WorkStealingQueue.hpp"
+#include <algorithm>
 #include <numeric/Combinatorics.hpp>
 #include <numeric/LimitedCombination.hpp>
 
@@ -100,63 +102,173 @@ std::string CoalitionStructureGeneration::Statistics::toString() const
     ss << "        searched: " << IntegerPartitioning::toString(searchedIntegerPartitions) << std::endl;
     std::vector<numeric::IntegerPartition> remain = remainingIntegerPartitions();
     ss << "        remaining: " << IntegerPartitioning::toString(remain) << std::endl;
+    ss << "    searched nodes: " << searchedNodes << std::endl;
     return ss.str();
 }
 
 CoalitionStructureGeneration::CoalitionStructureGeneration(const AtomicAgent::List& agents, CoalitionValueFunction coalitionValueFunction, CoalitionStructureValueFunction coalitionStructureValueFunction)
     : mAgents(agents)
-    , mCoalitionValueFunction(coalitionValueFunction)
+    , mCoalitionValueCache(new CoalitionValueCache(coalitionValueFunction, DEFAULT_COALITION_VALUE_CACHE_SIZE))
     , mCoalitionStructureValueFunction(coalitionStructureValueFunction)
+    , mNumberOfThreads(1)
+    , mLastPublishedValue(0.0)
+    , mStopRequested(false)
 {
     reset();
 }
 
-void CoalitionStructureGeneration::prepare()
+CoalitionStructureGeneration::CoalitionStructureGeneration(const AtomicAgent::List& agents, const CoalitionValueCache::Ptr& coalitionValueCache, CoalitionStructureValueFunction coalitionStructureValueFunction)
+    : mAgents(agents)
+    , mCoalitionValueCache(coalitionValueCache)
+    , mCoalitionStructureValueFunction(coalitionStructureValueFunction)
+    , mNumberOfThreads(1)
+    , mLastPublishedValue(0.0)
+    , mStopRequested(false)
 {
-    using namespace numeric;
-    ModelPool modelPool = AtomicAgent::getModelPool(mAgents);
-    LimitedCombination<owlapi::model::IRI> combinations(modelPool, mAgents.size(), MAX);
-    do {
+    if(!mCoalitionValueCache)
+    {
+        throw std::invalid_argument("moreorg::utils::CoalitionStructureGeneration: coalition value cache is not set");
+    }
+    reset();
+}
+
+struct CoalitionStructureGeneration::ParallelSearch
+{
+    ParallelSearch(size_t numberOfWorkers)
+        : queues(numberOfWorkers)
+        , pendingTasks(0)
+        , stop(false)
+    {}
+
+    /**
+     * Check if any worker queue contains a task
+     */
+    bool hasTasks() const
+    {
+        for(const WorkStealingQueue<SubspaceTask>& queue : queues)
+        {
+            if(!queue.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
 
-        ModelCombination coalition = combinations.current();
-        ModelPool m(coalition);
-        AtomicAgent::List agents = AtomicAgent::toList(m);
+    /**
+     * Stop the search and wake up the waiting workers
+     */
+    void requestStop()
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        stop = true;
+        changed.notify_all();
+    }
 
-        mAgentCoalitionMap[coalition.size()].insert(agents);
-    } while(combinations.next());
+    /**
+     * Take a task from the worker's own queue or steal one from
+     * another worker
+     */
+    bool take(size_t worker, SubspaceTask& task)
+    {
+        if(queues[worker].pop(task))
+        {
+            return true;
+        }
+        for(size_t i = 1; i < queues.size(); ++i)
+        {
+            if(queues[(worker + i) % queues.size()].steal(task))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
 
+    std::vector< WorkStealingQueue<SubspaceTask> > queues;
+    /// Number of tasks which have been added, but not yet completed
+    std::atomic<size_t> pendingTasks;
+    std::atomic<bool> stop;
+
+    /// Guards boundMap and openTasks, and is held when adding tasks or
+    /// completing them, so that waiting workers do not miss a change
+    boost::mutex mutex;
+    /// Signalled (with mutex) when tasks have been added, all tasks
+    /// have been completed or the search has been stopped
+    boost::condition_variable changed;
+    /// Bounds of the subspaces which have not been completely searched
+    IntegerPartitionBoundsMap boundMap;
+    /// Number of tasks per subspace which have not been completed
+    std::map<IntegerPartition, size_t> openTasks;
+};
+
+void CoalitionStructureGeneration::prepare()
+{
+    using namespace numeric;
 
     // Compute bounds for coalitions a given size, e.g.
     // coalition of size 1: max 100, min 10, average 50
     // coalition of size 2: max 200, min 24, average 54
-    AgentCoalitionMap::const_iterator ait = mAgentCoalitionMap.begin();
-    for(; ait != mAgentCoalitionMap.end(); ++ait)
+    //
+    // The coalitions are only enumerated, not stored, so that only the
+    // accumulated values per coalition size are kept
+    CoalitionBoundMap boundMap;
+    std::map<size_t, double> sums;
+    std::map<size_t, size_t> counts;
+
+    // Keep the agents sorted, so that the coalitions created during the search
+    // are sorted as well and can be looked up in the cache without copying
+    std::sort(mAgents.begin(), mAgents.end());
+    ModelPool modelPool = AtomicAgent::getModelPool(mAgents);
+
+    // Number the agent models in order to count agents per model during
+    // the search
+    std::map<owlapi::model::IRI, size_t> types;
+    for(const ModelPool::value_type& entry : modelPool)
+    {
+        size_t type = types.size();
+        types[entry.first] = type;
+    }
+    mNumberOfAgentTypes = types.size();
+    mAgentTypes.clear();
+    mAgentIndices.clear();
+    for(size_t i = 0; i < mAgents.size(); ++i)
     {
-        Bounds bounds;
-        const std::set< Coalition >& coalitions = ait->second;
+        mAgentTypes.push_back( types[ mAgents[i].getModel() ] );
+        mAgentIndices.insert( std::make_pair(mAgents[i], i) );
+    }
 
-        std::set<Coalition>::const_iterator cit = coalitions.begin();
-        double sum = 1.0;
-        for(;  cit != coalitions.end(); ++cit)
-        {
-            const Coalition& coalition = *cit;
-            double value = mCoalitionValueFunction(coalition);
+    LimitedCombination<owlapi::model::IRI> combinations(modelPool, mAgents.size(), MAX);
+    do {
+        ModelPool m(combinations.current());
+        AtomicAgent::List coalition = AtomicAgent::toList(m);
+        double value = mCoalitionValueCache->getValue(coalition);
 
-            LOG_DEBUG_S << "Coalition value: " << value;
+        LOG_DEBUG_S << "Coalition value: " << value;
 
-            sum += value;
-            if(value > bounds.maximum)
-            {
-                bounds.maximum = value;
-            }
-            if(value < bounds.minimum)
-            {
-                bounds.minimum = value;
-            }
+        size_t coalitionSize = coalition.size();
+        Bounds& bounds = boundMap[coalitionSize];
+        if(counts[coalitionSize]++ == 0)
+        {
+            sums[coalitionSize] = 1.0;
+        }
+        sums[coalitionSize] += value;
+        if(value > bounds.maximum)
+        {
+            bounds.maximum = value;
+        }
+        if(value < bounds.minimum)
+        {
+            bounds.minimum = value;
         }
-        bounds.average = sum / coalitions.size();
+    } while(combinations.next());
 
-        size_t coalitionSize = ait->first;
+    CoalitionBoundMap::iterator bit = boundMap.begin();
+    for(; bit != boundMap.end(); ++bit)
+    {
+        size_t coalitionSize = bit->first;
+        Bounds& bounds = bit->second;
+        bounds.average = sums[coalitionSize] / counts[coalitionSize];
         mCoalitionBoundMap[coalitionSize] = bounds;
     }
 
@@ -318,8 +430,32 @@ void CoalitionStructureGeneration::reset()
     prepare();
 }
 
+void CoalitionStructureGeneration::setNumberOfThreads(size_t numberOfThreads)
+{
+    if(numberOfThreads == 0)
+    {
+        numberOfThreads = std::max(1u, boost::thread::hardware_concurrency());
+    }
+    mNumberOfThreads = numberOfThreads;
+}
+
 CoalitionStructure CoalitionStructureGeneration::findBest(double quality)
 {
+    mStopRequested = false;
+    return runSearch(quality);
+}
+
+CoalitionStructure CoalitionStructureGeneration::runSearch(double quality)
+{
+    mStartTime = base::Time::now();
+    mDeadline = mTimeout.isNull() ? base::Time() : mStartTime + mTimeout;
+    mLastPublishedValue = 0.0;
+
+    if(mNumberOfThreads > 1)
+    {
+        return findBestParallel(quality);
+    }
+
     IntegerPartitionBoundsMap boundMap = prune(mIntegerPartitionBoundsMap);
     mGlobalUpperBound = bestUpperBound(boundMap);
 
@@ -327,6 +463,12 @@ CoalitionStructure CoalitionStructureGeneration::findBest(double quality)
     //CoalitionBoundMap boundMap = prune(mCoalitionBoundMap);
     while(true)
     {
+        if(timeoutReached())
+        {
+            LOG_INFO_S << "Timeout reached: best coalition found so far: " << currentBestSolution() << ", value " << currentBestSolutionValue();
+            break;
+        }
+
         LOG_INFO_S << "Select currently best integer partition";
         IntegerPartition partition;
         try {
@@ -342,7 +484,21 @@ CoalitionStructure CoalitionStructureGeneration::findBest(double quality)
             boost::unique_lock<boost::mutex> lock(mStatisticsMutex);
             mStatistics.searchedIntegerPartitions.push_back(partition);
         }
-        bool improvedResult = searchSubspace(partition, 0, 0, mAgents, CoalitionStructure(), quality);
+        bool completed = true;
+        bool improvedResult = searchSubspace(partition, 0, 0, mAgents, CoalitionStructure(), quality, NULL, &completed);
+
+        if(!completed)
+        {
+            // The bound of the partially searched subspace remains part of
+            // the global upper bound
+            if(currentBestSolutionQuality() <= quality)
+            {
+                LOG_INFO_S << "Good enough coalition found: " << currentBestSolution() << ", value " << currentBestSolutionValue();
+            } else {
+                LOG_INFO_S << "Timeout reached: best coalition found so far: " << currentBestSolution() << ", value " << currentBestSolutionValue();
+            }
+            break;
+        }
 
         // No improvement of the results
         if(!improvedResult)
@@ -379,15 +535,190 @@ CoalitionStructure CoalitionStructureGeneration::findBest(double quality)
     return currentBestSolution();
 }
 
+CoalitionStructure CoalitionStructureGeneration::findBestParallel(double quality)
+{
+    size_t numberOfWorkers = mNumberOfThreads;
+    ParallelSearch search(numberOfWorkers);
+    search.boundMap = prune(mIntegerPartitionBoundsMap);
+    mGlobalUpperBound = bestUpperBound(search.boundMap);
+
+    // Order the subspaces as the serial search would select them
+    std::vector<IntegerPartition> subspaces;
+    IntegerPartitionBoundsMap candidates = search.boundMap;
+    while(!candidates.empty())
+    {
+        IntegerPartition partition;
+        try {
+            partition = selectIntegerPartition(candidates, mGlobalUpperBound);
+        } catch(const std::runtime_error& e)
+        {
+            LOG_DEBUG_S << "No better partition found";
+            break;
+        }
+        subspaces.push_back(partition);
+        candidates.erase(partition);
+    }
+
+    // Distribute the subspaces, so that each worker starts with its most
+    // promising one, i.e. the one added last
+    for(size_t i = subspaces.size(); i > 0; --i)
+    {
+        SubspaceTask task;
+        task.partition = subspaces[i-1];
+        task.k = 0;
+        task.alpha = 0;
+        task.agents = mAgents;
+
+        search.openTasks[task.partition] = 1;
+        search.queues[(i-1) % numberOfWorkers].push(task);
+    }
+    search.pendingTasks = subspaces.size();
+
+    LOG_INFO_S << "Search " << subspaces.size() << " subspaces using " << numberOfWorkers << " threads";
+    boost::thread_group workers;
+    for(size_t i = 0; i < numberOfWorkers; ++i)
+    {
+        workers.create_thread([this, &search, i, quality]()
+                {
+                    runSubspaceWorker(&search, i, quality);
+                });
+    }
+
+    try {
+        workers.join_all();
+    } catch(const boost::thread_interrupted& e)
+    {
+        // the anytime search has been stopped
+        search.requestStop();
+        workers.join_all();
+        throw;
+    }
+    mCompletionTime = base::Time::now();
+
+    LOG_DEBUG_S << "Best coalition found: " << currentBestSolution() << ", " << currentBestSolutionValue();
+    return currentBestSolution();
+}
+
+void CoalitionStructureGeneration::runSubspaceWorker(ParallelSearch* search, size_t worker, double quality)
+{
+    SubspaceTask task;
+    while(!search->stop)
+    {
+        if(timeoutReached())
+        {
+            LOG_INFO_S << "Timeout reached: best coalition found so far: " << currentBestSolution() << ", value " << currentBestSolutionValue();
+            search->requestStop();
+            break;
+        }
+
+        if(!search->take(worker, task))
+        {
+            // Tasks in progress might still add new ones, so wait until
+            // this happens or all tasks have been completed
+            boost::unique_lock<boost::mutex> lock(search->mutex);
+            while(!search->stop && search->pendingTasks != 0 && !search->hasTasks())
+            {
+                search->changed.wait(lock);
+            }
+            if(search->pendingTasks == 0)
+            {
+                break;
+            }
+            continue;
+        }
+        searchSubspaceTask(search, worker, task, quality);
+    }
+}
+
+void CoalitionStructureGeneration::searchSubspaceTask(ParallelSearch* search, size_t worker, const SubspaceTask& task, double quality)
+{
+    const IntegerPartition& partition = task.partition;
+    bool open;
+    {
+        boost::unique_lock<boost::mutex> lock(search->mutex);
+        open = search->boundMap.count(partition);
+    }
+
+    // Skip subspaces that have been pruned in the meantime, or where the
+    // upper bound has already been reached
+    bool completed = true;
+    if(open && currentBestSolutionValue() < mIntegerPartitionBoundsMap.at(partition).maximum)
+    {
+        bool improvedResult = false;
+        if(task.k == 0)
+        {
+            LOG_INFO_S << "Compute best coalition structure for this subspace: " << IntegerPartitioning::toString(partition);
+            boost::unique_lock<boost::mutex> lock(mStatisticsMutex);
+            mStatistics.searchedIntegerPartitions.push_back(partition);
+        }
+
+        if(task.k == 0 && partition.size() > 1)
+        {
+            // Split the subspace along the choice of the first coalition
+            std::vector<SubspaceTask> tasks;
+            improvedResult = searchSubspace(partition, task.k, task.alpha, task.agents, task.structure, quality, &tasks, &completed);
+            if(!tasks.empty())
+            {
+                boost::unique_lock<boost::mutex> lock(search->mutex);
+                search->openTasks[partition] += tasks.size();
+                search->pendingTasks += tasks.size();
+                for(const SubspaceTask& t : tasks)
+                {
+                    search->queues[worker].push(t);
+                }
+                search->changed.notify_all();
+            }
+        } else {
+            improvedResult = searchSubspace(partition, task.k, task.alpha, task.agents, task.structure, quality, NULL, &completed);
+        }
+
+        if(improvedResult)
+        {
+            boost::unique_lock<boost::mutex> lock(search->mutex);
+            search->boundMap = prune(search->boundMap);
+            mGlobalUpperBound = bestUpperBound(search->boundMap);
+            if(currentBestSolutionQuality() <= quality)
+            {
+                LOG_INFO_S << "Good enough coalition found: " << currentBestSolution() << ", value " << currentBestSolutionValue();
+                search->stop = true;
+                search->changed.notify_all();
+            }
+        }
+    }
+
+    boost::unique_lock<boost::mutex> lock(search->mutex);
+    if(completed)
+    {
+        std::map<IntegerPartition, size_t>::iterator it = search->openTasks.find(partition);
+        if(--it->second == 0)
+        {
+            // The subspace has been completely searched
+            search->openTasks.erase(it);
+            search->boundMap.erase(partition);
+            mGlobalUpperBound = bestUpperBound(search->boundMap);
+        }
+    } else {
+        // The search has been aborted (timeout or sufficient quality), so
+        // that the bound of this subspace remains part of the global upper bound
+        search->stop = true;
+    }
+    if(--search->pendingTasks == 0 || search->stop)
+    {
+        search->changed.notify_all();
+    }
+}
+
 void CoalitionStructureGeneration::anytimeSearch(double quality)
 {
     mStartTime = base::Time::now();
     mCompletionTime = base::Time();
-    mThread = boost::thread(&CoalitionStructureGeneration::findBest, this, quality);
+    mStopRequested = false;
+    mThread = boost::thread(&CoalitionStructureGeneration::runSearch, this, quality);
 }
 
 void CoalitionStructureGeneration::stopSearch()
 {
+    mStopRequested = true;
     mThread.interrupt();
 }
 
@@ -399,7 +730,6 @@ CoalitionStructure CoalitionStructureGeneration::currentBestSolution() const
 
 double CoalitionStructureGeneration::currentBestSolutionValue() const
 {
-    boost::unique_lock<boost::mutex> lock(mSolutionMutex);
     return mCurrentBestCoalitionStructureValue;
 }
 
@@ -451,7 +781,55 @@ IntegerPartition CoalitionStructureGeneration::selectIntegerPartition(const Coal
     // the given number of coalitions
 }
 
+namespace {
+
+/**
+ * Set counts to the first combination of the given size, where each entry is
+ * limited by the available number
+ * \return false if no such combination exists
+ */
+bool firstCombination(size_t* counts, const size_t* available, size_t numberOfTypes, size_t size)
+{
+    for(size_t t = 0; t < numberOfTypes; ++t)
+    {
+        counts[t] = std::min(size, available[t]);
+        size -= counts[t];
+    }
+    return size == 0;
+}
+
+/**
+ * Advance counts to the next combination of the same size (in decreasing
+ * lexicographical order)
+ * \return false if counts was the last combination
+ */
+bool nextCombination(size_t* counts, const size_t* available, size_t numberOfTypes)
+{
+    size_t suffixCount = 0;
+    size_t suffixAvailable = 0;
+    for(size_t t = numberOfTypes; t-- > 0;)
+    {
+        if(counts[t] > 0 && suffixCount < suffixAvailable)
+        {
+            // Move one item from type t to the following types
+            --counts[t];
+            firstCombination(counts + t + 1, available + t + 1, numberOfTypes - t - 1, suffixCount + 1);
+            return true;
+        }
+        suffixCount += counts[t];
+        suffixAvailable += available[t];
+    }
+    return false;
+}
+
+} // end anonymous namespace
+
 /**
+ * The search iterates over the levels k of the partition using an explicit stack,
+ * where all buffers are allocated upfront:
+ * for each level the remaining agents (as index into mAgents), the number
+ * of available agents per model, the current combination (number of agents per
+ * model) and the state of the enumeration
  *
  * \param globalUpperBound
  * \param bestStar Quality of the solution, i.e. 1.05 means 95% percent of the optimal solution
@@ -459,166 +837,280 @@ IntegerPartition CoalitionStructureGeneration::selectIntegerPartition(const Coal
 bool CoalitionStructureGeneration::searchSubspace(const IntegerPartition& partition,
         size_t k, size_t alpha,
         const AtomicAgent::List& agents,
-        const CoalitionStructure& currentStructure, double betaStar)
+        const CoalitionStructure& currentStructure, double betaStar,
+        std::vector<SubspaceTask>* tasks, bool* completed)
 {
     bool improvedResult = false;
-
-    std::string indent(4*k, ' ');
-    LOG_DEBUG_S << indent << " search subspace of current structure: " << currentStructure;
-
-    if(k > 0 && partition[k] != partition[k-1])
+    if(completed)
     {
-        LOG_DEBUG_S << indent << " search subspace for k: " << k << ", partition[k]: " << partition[k] << " != " << partition[k-1];
-        // resetting alpha when the size is not repeated
-        alpha = 1;
+        *completed = true;
     }
+    size_t numberOfNodes = 0;
+
+    const size_t numberOfAgents = mAgents.size();
+    const size_t numberOfTypes = mNumberOfAgentTypes;
+    const size_t depth = partition.size();
 
+    // Compute upper bound of subspace, so that we can stop computation when this maximum has
+    // been reached
+    double upperBoundOfSubspace = mIntegerPartitionBoundsMap.at(partition).maximum;
+    LOG_DEBUG_S << "upperBound of subspace " << IntegerPartitioning::toString(partition) << ": " << upperBoundOfSubspace;
 
     // Compute upper bound for M_{k,0} to avoid redundant computations
-    int upperBoundM_k = mAgents.size() + 1;
-    for(size_t i = 0; i < k; ++i)
+    std::vector<int> upperBoundM(depth, numberOfAgents + 1);
+    for(size_t level = 1; level < depth; ++level)
     {
-        upperBoundM_k += partition[i]*IntegerPartitioning::multiplicity(partition, partition[i]);
+        upperBoundM[level] = upperBoundM[level-1] + partition[level-1]*IntegerPartitioning::multiplicity(partition, partition[level-1]);
     }
-    LOG_DEBUG_S << indent << " upperBound M_k: " << upperBoundM_k;
 
-    // Compute upper bound of subspace, so that we can stop computation when this maximum has
-    // been reached
-    double upperBoundOfSubspace = mIntegerPartitionBoundsMap[partition].maximum;
-    LOG_DEBUG_S << indent << " upperBound of subspace " << IntegerPartitioning::toString(partition) << ": " << upperBoundOfSubspace;
+    // Potential of the yet unassigned coalitions of a level and all following
+    // ones, based on the bounds computed on coalition sizes
+    std::vector<double> remainingPotential(depth + 1, 1.0);
+    for(size_t level = depth; level-- > 0;)
+    {
+        remainingPotential[level] = std::min(remainingPotential[level+1], mCoalitionBoundMap.at( partition[level] ).maximum);
+    }
 
-    using namespace numeric;
-    ModelPool modelPool = AtomicAgent::getModelPool(agents);
-    LimitedCombination<owlapi::model::IRI> combinations(modelPool, partition[k], EXACT);
-    do {
-        ModelCombination coalition = combinations.current();
-        // translate to index
-        ModelPool m(coalition);
+    // Per level buffers
+    std::vector<size_t> remaining(depth*numberOfAgents);
+    std::vector<size_t> numberOfRemaining(depth, 0);
+    std::vector<size_t> available(depth*numberOfTypes, 0);
+    std::vector<size_t> counts(depth*numberOfTypes, 0);
+    std::vector<size_t> taken(numberOfTypes, 0);
+    std::vector<size_t> alphas(depth, 0);
+    std::vector<size_t> firstIndex(depth, 0);
+    std::vector<bool> started(depth, false);
+    // Minimum value of the coalitions before a level
+    std::vector<double> structurePotential(depth, 1.0);
+
+    CoalitionStructure structure = currentStructure;
+    structure.resize(depth);
+    for(size_t level = k; level < depth; ++level)
+    {
+        structure[level].resize(partition[level]);
+    }
+
+    for(const AtomicAgent& agent : agents)
+    {
+        std::map<AtomicAgent, size_t>::const_iterator cit = mAgentIndices.find(agent);
+        if(cit == mAgentIndices.end())
+        {
+            throw std::invalid_argument("moreorg::utils::CoalitionStructureGeneration::searchSubspace: unknown agent '" + agent.toString() + "'");
+        }
+        size_t index = cit->second;
+        remaining[k*numberOfAgents + numberOfRemaining[k]++] = index;
+        ++available[k*numberOfTypes + mAgentTypes[index]];
+    }
+    for(size_t i = 0; i < k; ++i)
+    {
+        double valueOfCoalition = mCoalitionValueCache->getValue( currentStructure[i] );
+        structurePotential[k] = std::min(valueOfCoalition, structurePotential[k]);
+    }
+    alphas[k] = alpha;
 
-        // m_k represent the an array of indices
-        std::vector<int> m_k;
-        for(size_t i = 0; i < agents.size(); ++i)
+    size_t level = k;
+    // Set when a level has been entered, i.e. alpha has to be checked
+    bool entered = true;
+    while(true)
+    {
+        if(entered)
         {
-            const AtomicAgent& agent = agents[i];
-            size_t& cardinality = m[agent.getModel()];
-            if(cardinality > 0)
+            entered = false;
+            if(level > 0 && partition[level] != partition[level-1])
             {
-                m_k.push_back(i);
-                --cardinality;
+                // resetting alpha when the size is not repeated
+                alphas[level] = 1;
             }
+            started[level] = false;
+        }
+
+        size_t* levelCounts = &counts[level*numberOfTypes];
+        const size_t* levelAvailable = &available[level*numberOfTypes];
+        bool valid;
+        if(started[level])
+        {
+            valid = nextCombination(levelCounts, levelAvailable, numberOfTypes);
+        } else {
+            valid = firstCombination(levelCounts, levelAvailable, numberOfTypes, partition[level]);
+            started[level] = true;
         }
-        LOG_DEBUG_S << indent << " current combination m_k=" << IntegerPartitioning::toString(m_k) << ", alpha=" << alpha;
-        // m_k[0] + 1: we start with index 0, but the algorithmic description uses 1 as first index
-        if(((int) alpha) <= m_k[0] + 1 && m_k[0] + 1 <= upperBoundM_k)
+
+        if(!valid)
         {
-            LOG_DEBUG_S << indent << " computing combination";
-            // Map combination of indices to current coalition, i.e. an agent (sub)set
-            AtomicAgent::List remainingAgents = agents;
-            AtomicAgent::List coalition;
-            for(size_t i = 0; i < m_k.size(); ++i)
+            // All combinations of this level have been searched
+            if(level == k)
             {
-                AtomicAgent agent = agents[ m_k[i] ];
-                coalition.push_back(agent);
-                std::vector<AtomicAgent>::iterator it = std::find(remainingAgents.begin(), remainingAgents.end(), agent);
-                remainingAgents.erase(it);
+                break;
+            }
+            --level;
+        } else {
+            // m_k[0]: index of the first remaining agent that is part of the
+            // combination
+            const size_t* levelRemaining = &remaining[level*numberOfAgents];
+            size_t m_k0 = 0;
+            while(levelCounts[ mAgentTypes[ levelRemaining[m_k0] ] ] == 0)
+            {
+                ++m_k0;
             }
-            CoalitionStructure coalitionStructure = currentStructure;
-            coalitionStructure.push_back(coalition);
-
-            LOG_DEBUG_S << indent << " current coalition structure: " << currentStructure;
-            LOG_DEBUG_S << indent << " partial coalition structure: " << coalitionStructure << " , remaining agents " << remainingAgents;
 
+            // m_k0 + 1: we start with index 0, but the algorithmic description uses 1 as first index
+            if(!( alphas[level] <= m_k0 + 1 && (int) m_k0 + 1 <= upperBoundM[level] ))
+            {
+                LOG_DEBUG_S << "skipping: condition does not hold: alpha < m_k[0]+1 && m_k[0]+1 <= upperBoundM_k"
+                    << ", alpha= " << alphas[level] << ", m_k[0]=" << m_k0 << ", upperBoundM_k=" << upperBoundM[level];
+                continue;
+            }
+            ++numberOfNodes;
+
+            // Map combination to the current coalition, i.e. the first agents of
+            // each model, while the others remain for the next level
+            bool last = (level == depth - 1);
+            std::copy(levelCounts, levelCounts + numberOfTypes, taken.begin());
+            Coalition& coalition = structure[level];
+            size_t* nextRemaining = last ? NULL : &remaining[(level+1)*numberOfAgents];
+            size_t* nextAvailable = last ? NULL : &available[(level+1)*numberOfTypes];
+            if(!last)
+            {
+                std::fill(nextAvailable, nextAvailable + numberOfTypes, 0);
+                numberOfRemaining[level+1] = 0;
+            }
+            size_t c = 0;
+            for(size_t i = 0; i < numberOfRemaining[level]; ++i)
+            {
+                size_t index = levelRemaining[i];
+                size_t type = mAgentTypes[index];
+                if(taken[type] > 0)
+                {
+                    --taken[type];
+                    coalition[c++] = mAgents[index];
+                } else if(!last)
+                {
+                    nextRemaining[ numberOfRemaining[level+1]++ ] = index;
+                    ++nextAvailable[type];
+                }
+            }
 
             // Check if we reached the end, i.e. when we have a complete coalition structure
-            if(k == partition.size() - 1)
+            if(last)
             {
-                double currentStructureValue = mCoalitionStructureValueFunction( coalitionStructure );
-                LOG_DEBUG_S << indent << " reached the end at k: " << k << " -- bestValue: " << currentBestSolution() << " vs. " << currentStructureValue;
+                double currentStructureValue = mCoalitionStructureValueFunction( structure );
+                LOG_DEBUG_S << "reached the end at k: " << level << " -- bestValue: " << currentBestSolutionValue() << " vs. " << currentStructureValue;
                 if(currentStructureValue > currentBestSolutionValue())
                 {
                     // update the currently best coalition structure
-                    LOG_DEBUG_S << indent << " update global best: " << currentBestSolution() << ", value " << currentBestSolutionValue();
-                    improvedResult = updateCurrentBestCoalitionStructure(coalitionStructure, currentStructureValue) || improvedResult;
+                    improvedResult = updateCurrentBestCoalitionStructure(structure, currentStructureValue) || improvedResult;
                 }
             } else {
-                LOG_DEBUG_S << indent << " computing subspace potential";
                 // Estimate the potential of this subspace using
                 // know value for the already found coalitions
                 // and existing upper bounds for the coalitions still
                 // to look at
-                double subspacePotentialValue = 1.0;
-
-                // Estimate value of current (partial) coalition structure
-                for( size_t i = 0; i < coalitionStructure.size(); ++i)
-                {
-                    double valueOfCoalition = mCoalitionValueFunction( coalitionStructure[i] );
-                    subspacePotentialValue = std::min(valueOfCoalition, subspacePotentialValue);
-                    LOG_DEBUG_S << indent << " coalition: " << coalitionStructure[i] << std::endl
-                            << indent << "     value: " << valueOfCoalition << std::endl
-                            << indent << "     current subspace potential: " << subspacePotentialValue << std::endl;
-                }
-
-                // Estimate value for the rest of the partition based on the bounds computed
-                // on coalition sizes, i.e.
-                // looking at the integer partition's yet uninvestigated range
-                for( size_t i = coalitionStructure.size(); i < partition.size(); ++i)
-                {
-                    double max_s = mCoalitionBoundMap[ partition[i] ].maximum;
-                    LOG_DEBUG_S << indent << " potential for coalition size: " << partition[i] << ": " << max_s;
-                    subspacePotentialValue = std::min(max_s, subspacePotentialValue);
-                }
-                LOG_DEBUG_S << indent << " subspace potential: " << subspacePotentialValue;
+                double valueOfCoalition = mCoalitionValueCache->getValue(coalition);
+                double potential = std::min(structurePotential[level], valueOfCoalition);
+                double subspacePotentialValue = std::min(potential, remainingPotential[level+1]);
+                LOG_DEBUG_S << "subspace potential at k: " << level << ": " << subspacePotentialValue;
 
                 // Check if it is worth to enter this subspace
                 if(currentBestSolutionValue() < subspacePotentialValue)
                 {
-                    LOG_DEBUG_S << indent << " continue search: best: " << currentBestSolutionValue() << " vs. subspace potential: " <<  subspacePotentialValue;
-                    if( searchSubspace(partition, k+1, m_k[0], remainingAgents, coalitionStructure, betaStar) )
+                    if(tasks)
                     {
-                        improvedResult = true;
+                        SubspaceTask task;
+                        task.partition = partition;
+                        task.k = level + 1;
+                        task.alpha = m_k0;
+                        for(size_t i = 0; i < numberOfRemaining[level+1]; ++i)
+                        {
+                            task.agents.push_back( mAgents[ nextRemaining[i] ] );
+                        }
+                        task.structure.assign(structure.begin(), structure.begin() + level + 1);
+                        tasks->push_back(task);
+                    } else {
+                        ++level;
+                        alphas[level] = m_k0;
+                        structurePotential[level] = potential;
+                        entered = true;
+                        continue;
                     }
                 } else {
-                    LOG_DEBUG_S << indent << " pruning: insufficient subspace potential: best: " << currentBestSolutionValue() << " vs. " <<  subspacePotentialValue;
+                    LOG_DEBUG_S << "pruning: insufficient subspace potential: best: " << currentBestSolutionValue() << " vs. " <<  subspacePotentialValue;
                 }
             }
+        }
 
-            // Stop if the required solution has been found or if the current best
-            // is equal to the upper bound of this sub-space
-            if( currentBestSolutionQuality() <= betaStar )
+        // Stop if the required solution has been found or if the current best
+        // is equal to the upper bound of this sub-space
+        if( currentBestSolutionQuality() <= betaStar )
+        {
+            LOG_DEBUG_S << "Quality sufficient: " << currentBestSolutionQuality() << "<=" << betaStar;
+            if(completed)
             {
-
-                LOG_DEBUG_S << indent << " prematurely returning best structure: " << currentBestSolution();
-                LOG_DEBUG_S << "Quality sufficient: " << currentBestSolutionQuality() << "<=" << betaStar;
-                return improvedResult;
+                *completed = false;
             }
+            break;
+        }
+
+        if(currentBestSolutionValue() >= upperBoundOfSubspace)
+        {
+            LOG_DEBUG_S << "bestStructureValue == upperBoundOfSubspace, both are " << currentBestSolutionValue();
+            break;
+        }
 
-            if(currentBestSolutionValue() == upperBoundOfSubspace)
+        // Check the time after each node, since evaluating a node might
+        // take long, e.g., for an expensive coalition structure value function
+        if(timeoutReached())
+        {
+            if(completed)
             {
-                LOG_DEBUG_S << indent << " prematurely returning best structure: " << currentBestSolution();
-                LOG_DEBUG_S << indent << " bestStructureValue == upperBoundOfSubspace, both are " << currentBestSolutionValue();
-                return improvedResult;
+                *completed = false;
             }
-        } else {
-        // if(alpha <= m_k[0] && m_k[0] <= upperBoundM_k)
-            LOG_DEBUG_S << indent << " skipping: condition does not hold: alpha < m_k[0]+1 && m_k[0]+1 <= upperBoundM_k"
-                << ", alpha= " << alpha << ", m_k[0]=" << m_k[0] << ", upperBoundM_k=" << upperBoundM_k;
+            break;
         }
-    } while(combinations.next());
+    }
 
+    {
+        boost::unique_lock<boost::mutex> lock(mStatisticsMutex);
+        mStatistics.searchedNodes += numberOfNodes;
+    }
     return improvedResult;
 }
 
 bool CoalitionStructureGeneration::updateCurrentBestCoalitionStructure(const CoalitionStructure& coalitionStructure, double value)
 {
-    boost::unique_lock<boost::mutex> lock(mSolutionMutex);
-    if(value > mCurrentBestCoalitionStructureValue)
     {
+        boost::unique_lock<boost::mutex> lock(mSolutionMutex);
+        if(value <= mCurrentBestCoalitionStructureValue)
+        {
+            return false;
+        }
         mCurrentBestCoalitionStructureValue = value;
         mCurrentBestCoalitionStructure = coalitionStructure;
-        return true;
     }
 
-    return false;
+    if(mSolutionCallback)
+    {
+        // The solution lock is not held, so that the callback can retrieve the
+        // current state -- a solution which has been superseded in the meantime is not published
+        boost::unique_lock<boost::mutex> lock(mSolutionCallbackMutex);
+        if(value > mLastPublishedValue)
+        {
+            mLastPublishedValue = value;
+
+            Solution solution;
+            solution.coalitionStructure = coalitionStructure;
+            solution.value = value;
+            solution.upperBound = mGlobalUpperBound;
+            solution.quality = solution.upperBound / value;
+            solution.elapsed = elapsed();
+            mSolutionCallback(solution);
+        }
+    }
+    return true;
+}
+
+bool CoalitionStructureGeneration::timeoutReached() const
+{
+    return mStopRequested || (!mDeadline.isNull() && base::Time::now() > mDeadline);
 }
 
 std::string CoalitionStructureGeneration::toString() const
@@ -1,6 +1,7 @@
 #ifndef ORGANIZATION_MODEL_UTILS_ORGANIZATION_STRUCTURE_GENERATION_HPP
 #define ORGANIZATION_MODEL_UTILS_ORGANIZATION_STRUCTURE_GENERATION_HPP
 
+#include <atomic>
 #include <limits>
 #include <boost/function.hpp>
 #include <boost/thread.hpp>
@@ -8,6 +9,7 @@
 #include <base/Time.hpp>
 #include <base-logging/Logging.hpp>
 #include "../Agent.hpp"
+#include "CoalitionValueCache.hpp"
 
 namespace moreorg {
 namespace utils {
@@ -36,41 +38,86 @@ std::ostream& operator<<(std::ostream& os, const Bounds& bounds);
 /**
  * This is an adapted implementation of the coalition structure generation as described in:
  * "An Anytime Algorithm for Optimal Coalition Structure Generation", (Rahwan et al., 2009)
- * Please note that the current implementation uses recursion
+ * The subspaces are searched iteratively, i.e. without recursion and
+ * without allocating memory per search node
  *
  * The adaption allows to account for a use of model pools and looking at the
  * identification coalition functions that have a boolean as characteristic value (1.0 or 0.0)
  * and thus represent an activation
+ *
+ * With more than one thread (see setNumberOfThreads) the integer partition subspaces are
+ * searched in parallel: workers take subspaces -- or, for subspaces with
+ * more than one coalition, the branches of the first coalition -- from
+ * work-stealing queues, while the value of the current best solution is shared
+ * for pruning. The value functions then have to be thread-safe.
+ *
+ * Coalitions are enumerated on demand and are not stored, only their values
+ * are kept in a CoalitionValueCache. A cache created for a coalition value
+ * function is limited to DEFAULT_COALITION_VALUE_CACHE_SIZE entries, so that the memory use
+ * does not grow with the number of coalitions.
  */
 class CoalitionStructureGeneration
 {
 public:
-    typedef boost::function1<double, const Coalition&> CoalitionValueFunction;
+    /// Maximum number of entries of the cache that is created for a coalition value function
+    enum { DEFAULT_COALITION_VALUE_CACHE_SIZE = 1 << 20 };
+
+    typedef CoalitionValueCache::CoalitionValueFunction CoalitionValueFunction;
     typedef boost::function1<double, const CoalitionStructure&> CoalitionStructureValueFunction;
 
     struct Statistics
     {
+        Statistics()
+            : searchedNodes(0)
+        {}
+
         std::vector<numeric::IntegerPartition> allIntegerPartitions;
         std::vector<numeric::IntegerPartition> prunedIntegerPartitions;
         std::vector<numeric::IntegerPartition> searchedIntegerPartitions;
+        /// Number of (partial) coalition structures that have been evaluated
+        size_t searchedNodes;
 
         std::vector<numeric::IntegerPartition> remainingIntegerPartitions() const;
 
         std::string toString() const;
     };
 
+    /**
+     * An improved solution as published to the solution callback
+     */
+    struct Solution
+    {
+        CoalitionStructure coalitionStructure;
+        double value;
+        /// Upper bound for the value of the optimal solution at the time the
+        /// solution has been found
+        double upperBound;
+        /// Ratio of upper bound and value, i.e. 1.05 means that the solution
+        /// is at least 95% of the optimal solution
+        double quality;
+        /// Time since the start of the search
+        base::Time elapsed;
+    };
+
+    /// Function that is called for every improved solution
+    typedef boost::function1<void, const Solution&> SolutionCallback;
+
 private:
     AtomicAgent::List mAgents;
     Statistics mStatistics;
 
-    // Agents listed by size of the coalition
-    typedef std::map<size_t, std::set< Coalition > > AgentCoalitionMap;
-    AgentCoalitionMap mAgentCoalitionMap;
+    /// Number of distinct agent models
+    size_t mNumberOfAgentTypes;
+    /// Index of the model of each agent
+    std::vector<size_t> mAgentTypes;
+    /// Index of each agent in mAgents
+    std::map<AtomicAgent, size_t> mAgentIndices;
 
     typedef std::map<size_t, Bounds> CoalitionBoundMap;
     CoalitionBoundMap mCoalitionBoundMap;
 
-    CoalitionValueFunction mCoalitionValueFunction;
+    /// Values of coalitions, all coalition values are retrieved from here
+    CoalitionValueCache::Ptr mCoalitionValueCache;
     CoalitionStructureValueFunction mCoalitionStructureValueFunction;
 
     typedef std::map<numeric::IntegerPartition, Bounds> IntegerPartitionBoundsMap;
@@ -82,12 +129,43 @@ private:
     base::Time mStartTime;
     base::Time mCompletionTime;
     CoalitionStructure mCurrentBestCoalitionStructure;
-    double mCurrentBestCoalitionStructureValue;
+    /// Written while holding mSolutionMutex, but read without locking
+    /// during the (parallel) search
+    std::atomic<double> mCurrentBestCoalitionStructureValue;
     double mCurrentSolutionQuality;
-    double mGlobalUpperBound;
+    std::atomic<double> mGlobalUpperBound;
+
+    size_t mNumberOfThreads;
+
+    /// Serializes the calls of the solution callback
+    boost::mutex mSolutionCallbackMutex;
+    SolutionCallback mSolutionCallback;
+    double mLastPublishedValue;
+    /// Maximum duration of a search, null for no limit
+    base::Time mTimeout;
+    base::Time mDeadline;
+    /// Set by stopSearch, so that the search stops as if the timeout had
+    /// been reached
+    std::atomic<bool> mStopRequested;
 
     /**
-     * Compute the integer partitions and the agent coalition map for coalition size up to
+     * A (part of a) subspace that remains to be searched, i.e. the arguments
+     * of searchSubspace
+     */
+    struct SubspaceTask
+    {
+        numeric::IntegerPartition partition;
+        size_t k;
+        size_t alpha;
+        AtomicAgent::List agents;
+        CoalitionStructure structure;
+    };
+
+    /// State shared by the workers of a parallel search
+    struct ParallelSearch;
+
+    /**
+     * Compute the integer partitions and the bounds for coalition size up to
      * the maximum number of agents
      */
     void prepare();
@@ -111,15 +189,52 @@ private:
      * the existing coalition structure
      * \param currentStructure the already constructed coalition structure
      * \param bestStar Quality of the solution, i.e. 1.05 means 95% percent of the optimal solution
+     * \param tasks If given, the subspace is only expanded by one level: the
+     * remaining search of each promising partial coalition structure is added as task instead of being
+     * searched recursively
+     * \param completed If given, set to false if the search has been aborted
+     * (timeout or sufficient quality) before the subspace has been
+     * completely searched, so that its upper bound remains valid
      * \return true if this subspace contained a better solution than already existed
      */
-    bool searchSubspace(const numeric::IntegerPartition& partition, size_t k, size_t alpha, const AtomicAgent::List& agents, const CoalitionStructure& currentStructure, double betaStar);
+    bool searchSubspace(const numeric::IntegerPartition& partition, size_t k, size_t alpha, const AtomicAgent::List& agents, const CoalitionStructure& currentStructure, double betaStar,
+            std::vector<SubspaceTask>* tasks = NULL, bool* completed = NULL);
+
+    /**
+     * Search as findBest, but keep a stop that has been requested already
+     */
+    CoalitionStructure runSearch(double quality);
+
+    /**
+     * Search all subspaces using mNumberOfThreads workers
+     */
+    CoalitionStructure findBestParallel(double quality);
+
+    /**
+     * Process tasks of a parallel search until all are done or the search
+     * has been stopped
+     */
+    void runSubspaceWorker(ParallelSearch* search, size_t worker, double quality);
+
+    /**
+     * Search a single task of a parallel search
+     */
+    void searchSubspaceTask(ParallelSearch* search, size_t worker, const SubspaceTask& task, double quality);
 
     bool updateCurrentBestCoalitionStructure(const CoalitionStructure& coalitionStructure, double value);
 
+    /**
+     * Check if the timeout of the current search has been reached or the
+     * search has been stopped
+     */
+    bool timeoutReached() const;
+
 public:
     /**
      * Find best coalitionstructure -- will block until coalition structure is found
+     * \param quality Stop once the ratio of upper bound and solution value
+     * is at most quality, e.g. 1.05 to stop at a solution within 95% of the optimal one
+     * (see also setTimeout)
      */
     CoalitionStructure findBest(double quality = 1.0);
 
@@ -128,6 +243,34 @@ public:
      */
     void reset();
 
+    /**
+     * Set the number of threads to search the subspaces with, by default
+     * a single thread is used
+     * \param numberOfThreads Number of threads, 0 to use one thread per core
+     */
+    void setNumberOfThreads(size_t numberOfThreads);
+
+    size_t getNumberOfThreads() const { return mNumberOfThreads; }
+
+    /**
+     * Set a function that is called for every improved solution as soon as
+     * it has been found -- as alternative to polling currentBestSolution
+     *
+     * The callback is called from the searching thread(s), but never
+     * concurrently and with solutions of increasing value. It should return
+     * quickly, since the search (thread) waits for it
+     */
+    void setSolutionCallback(SolutionCallback callback) { mSolutionCallback = callback; }
+
+    /**
+     * Limit the duration of a search, i.e. the search stops with the best
+     * solution found so far when the timeout has been reached
+     * \param timeout Maximum duration, base::Time() for no limit (default)
+     */
+    void setTimeout(const base::Time& timeout) { mTimeout = timeout; }
+
+    const base::Time& getTimeout() const { return mTimeout; }
+
     /**
      * Search for a solution and allow retrieval of intermediate results via currentBestSolution
      */
@@ -146,7 +289,10 @@ public:
     base::Time elapsed() const { return base::Time::now() - mStartTime; }
 
     /**
-     * Stop the search before completion
+     * Stop the search before completion, i.e. the search stops with the best
+     * solution found so far as for a timeout
+     * This can be called from any thread, including from the value functions
+     * and the solution callback during findBest
      */
     void stopSearch();
 
@@ -169,6 +315,23 @@ public:
             CoalitionValueFunction coalitionValueFunction,
             CoalitionStructureValueFunction coalitionStructureValueFunction);
 
+    /**
+     * Create the coalition structure generation using an existing cache, e.g.,
+     * to share it with the coalition structure value function or to
+     * precompute the values in parallel (see CoalitionValueCache::precompute)
+     * \params agents List of agents that are available
+     * \param coalitionValueCache Cache that provides the value of an individual coalition
+     * \param coalitionStructureValueFunction Function that allows to compute the value of a coalition structure
+     */
+    CoalitionStructureGeneration(const AtomicAgent::List& agents,
+            const CoalitionValueCache::Ptr& coalitionValueCache,
+            CoalitionStructureValueFunction coalitionStructureValueFunction);
+
+    /**
+     * Get the cache of the coalition values, e.g., to retrieve its statistics
+     */
+    CoalitionValueCache::Ptr getCoalitionValueCache() const { return mCoalitionValueCache; }
+
 
     /**
      * Stringify status of this CoalitionStructureGeneration object
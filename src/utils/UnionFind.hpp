@@ -0,0 +1,99 @@
+#ifndef ORGANIZATION_MODEL_UTILS_UNION_FIND_HPP
+#define ORGANIZATION_MODEL_UTILS_UNION_FIND_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace moreorg {
+namespace utils {
+
+/**
+ * \class UnionFind
+ * \brief Disjoint-set forest over the indices [0,size)
+ *
+ * \details
+ * For up to INLINE_CAPACITY elements the forest is stored inside the object,
+ * so that a stack instance does not require any heap allocation
+ */
+class UnionFind
+{
+public:
+    enum { INLINE_CAPACITY = 64 };
+
+    /**
+     * Create a forest with one set per element
+     * \param size Number of elements
+     */
+    explicit UnionFind(size_t size)
+        : mpParent(mInlineParent)
+        , mSize(size)
+        , mNumberOfSets(size)
+    {
+        if(size > INLINE_CAPACITY)
+        {
+            mHeapParent.resize(size);
+            mpParent = mHeapParent.data();
+        }
+        for(size_t i = 0; i < size; ++i)
+        {
+            mpParent[i] = i;
+        }
+    }
+
+    /**
+     * Find the representative of the set the element belongs to
+     */
+    size_t find(size_t element)
+    {
+        while(mpParent[element] != element)
+        {
+            // path halving
+            mpParent[element] = mpParent[ mpParent[element] ];
+            element = mpParent[element];
+        }
+        return element;
+    }
+
+    /**
+     * Merge the sets of two elements
+     * \return false if both elements already belonged to the same set, true
+     * otherwise
+     */
+    bool merge(size_t a, size_t b)
+    {
+        size_t rootA = find(a);
+        size_t rootB = find(b);
+        if(rootA == rootB)
+        {
+            return false;
+        }
+        mpParent[rootA] = rootB;
+        --mNumberOfSets;
+        return true;
+    }
+
+    /**
+     * Get the number of elements
+     */
+    size_t size() const { return mSize; }
+
+    /**
+     * Get the number of disjoint sets
+     */
+    size_t getNumberOfSets() const { return mNumberOfSets; }
+
+private:
+    UnionFind(const UnionFind& other);
+    UnionFind& operator=(const UnionFind& other);
+
+    uint32_t mInlineParent[INLINE_CAPACITY];
+    std::vector<uint32_t> mHeapParent;
+    uint32_t* mpParent;
+    size_t mSize;
+    size_t mNumberOfSets;
+};
+
+} // end namespace utils
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_UTILS_UNION_FIND_HPP
@@ -0,0 +1,87 @@
+#ifndef ORGANIZATION_MODEL_UTILS_WORK_STEALING_QUEUE_HPP
+#define ORGANIZATION_MODEL_UTILS_WORK_STEALING_QUEUE_HPP
+
+#include <deque>
+#include <boost/thread/mutex.hpp>
+
+namespace moreorg {
+namespace utils {
+
+/**
+ * \class WorkStealingQueue
+ * \brief Task queue of a single worker, which other workers can steal from
+ *
+ * \details
+ * The owning worker pushes and pops at the back, i.e. it processes the most
+ * recently added task first, while other workers steal the oldest task from
+ * the front
+ \verbatim
+    std::vector< WorkStealingQueue<Task> > queues(numberOfWorkers);
+    Task task;
+    if(queues[worker].pop(task) || queues[other].steal(task))
+    {
+        ...
+    }
+ \endverbatim
+ */
+template<typename T>
+class WorkStealingQueue
+{
+public:
+    /**
+     * Add a task (owner only)
+     */
+    void push(const T& task)
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        mTasks.push_back(task);
+    }
+
+    /**
+     * Take the most recently added task (owner only)
+     * \return false if the queue is empty
+     */
+    bool pop(T& task)
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        if(mTasks.empty())
+        {
+            return false;
+        }
+        task = mTasks.back();
+        mTasks.pop_back();
+        return true;
+    }
+
+    /**
+     * Take the oldest task (any other worker)
+     * \return false if the queue is empty
+     */
+    bool steal(T& task)
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        if(mTasks.empty())
+        {
+            return false;
+        }
+        task = mTasks.front();
+        mTasks.pop_front();
+        return true;
+    }
+
+    size_t size() const
+    {
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        return mTasks.size();
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    mutable boost::mutex mMutex;
+    std::deque<T> mTasks;
+};
+
+} // end namespace utils
+} // end namespace moreorg
+#endif // ORGANIZATION_MODEL_UTILS_WORK_STEALING_QUEUE_HPP
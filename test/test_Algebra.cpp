@@ -1,10 +1,14 @@
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <set>
+#include <tuple>
 #include <moreorg/OrganizationModel.hpp>
 #include <moreorg/OrganizationModelAsk.hpp>
 #include <moreorg/Algebra.hpp>
 #include "test_utils.hpp"
 #include <moreorg/vocabularies/OM.hpp>
 #include <moreorg/algebra/Connectivity.hpp>
+#include <moreorg/algebra/ConnectivityEnumerator.hpp>
 #include <graph_analysis/BaseGraph.hpp>
 #include <graph_analysis/GraphIO.hpp>
 
@@ -472,6 +476,217 @@ BOOST_AUTO_TEST_CASE(connectivity_multiple_interfaces)
     }
 }
 
+BOOST_AUTO_TEST_CASE(interface_compatibility)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    OrganizationModelAsk ask(om);
+
+    owlapi::model::IRI ifModel0 = vocabulary::OM::resolve("EmiActive");
+    owlapi::model::IRI ifModel1 = vocabulary::OM::resolve("EmiPassive");
+
+    InterfaceCompatibility::Ptr compatibility = ask.getInterfaceCompatibility();
+    BOOST_TEST_MESSAGE(compatibility->toString());
+    BOOST_REQUIRE_MESSAGE(compatibility->isCompatible(ifModel0, ifModel1), "EmiActive is compatible with EmiPassive");
+    BOOST_REQUIRE_MESSAGE(compatibility->isCompatible(ifModel0, ifModel1) ==
+            ask.ontology().isRelatedTo(ifModel0, vocabulary::OM::compatibleWith(), ifModel1),
+            "Compatibility matches the ontology query");
+
+    OrganizationModelAsk otherAsk(om);
+    BOOST_REQUIRE_MESSAGE(compatibility == otherAsk.getInterfaceCompatibility(), "Compatibility is shared per organization model");
+
+    // Classes outside of the interface hierarchy are compatible with nothing
+    owlapi::model::IRI unknownModel = vocabulary::OM::resolve("Sherpa");
+    size_t unknownId = compatibility->findId(unknownModel);
+    BOOST_REQUIRE_MESSAGE(unknownId == InterfaceCompatibility::UNKNOWN_ID, "Sherpa is not an interface");
+    BOOST_REQUIRE_MESSAGE(!compatibility->isCompatible(unknownId, compatibility->getId(ifModel1)), "Unknown interface is not compatible");
+    BOOST_REQUIRE_THROW(compatibility->getId(unknownModel), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(connectivity_propagation)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    OrganizationModelAsk ask(om);
+
+    // Disconnected assignments are pruned during search, so that the first
+    // solution has to be a connected one
+    {
+        Connectivity::resetQueryCache();
+        ModelPool modelPool;
+        modelPool[vocabulary::OM::resolve("Sherpa")] = 4;
+        modelPool[vocabulary::OM::resolve("CREX")] = 3;
+
+        graph_analysis::BaseGraph::Ptr baseGraph;
+        BOOST_REQUIRE_MESSAGE(Connectivity::isFeasible(modelPool, ask, baseGraph), "ModelPool: " << modelPool.toString() );
+        BOOST_REQUIRE_MESSAGE(Connectivity::getStatistics().evaluations == 1, "Expected a single evaluation, but got: " << Connectivity::getStatistics().toString());
+        BOOST_REQUIRE_MESSAGE(baseGraph && baseGraph->isConnected(), "Expected connected graph");
+    }
+    {
+        Connectivity::resetQueryCache();
+        ModelPool modelPool;
+        modelPool[vocabulary::OM::resolve("CREX")] = 2;
+
+        BOOST_REQUIRE_MESSAGE(!Connectivity::isFeasible(modelPool, ask), "ModelPool: " << modelPool.toString() );
+        BOOST_REQUIRE_MESSAGE(Connectivity::getStatistics().evaluations == 0, "Expected no evaluation, but got: " << Connectivity::getStatistics().toString());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(connectivity_witness)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    OrganizationModelAsk ask(om);
+
+    Connectivity::resetQueryCache();
+    {
+        ModelPool modelPool;
+        modelPool[vocabulary::OM::resolve("Payload")] = 2;
+        BOOST_REQUIRE_MESSAGE(Connectivity::isFeasible(modelPool, ask), "ModelPool: " << modelPool.toString() );
+        BOOST_REQUIRE_MESSAGE(Connectivity::getStatistics().evaluations > 0, "Expected search for the initial model pool");
+    }
+    // The witness of the smaller pool is extended without search
+    {
+        ModelPool modelPool;
+        modelPool[vocabulary::OM::resolve("Payload")] = 10;
+
+        graph_analysis::BaseGraph::Ptr baseGraph;
+        BOOST_REQUIRE_MESSAGE(Connectivity::isFeasible(modelPool, ask, baseGraph), "ModelPool: " << modelPool.toString() );
+        BOOST_REQUIRE_MESSAGE(Connectivity::getStatistics().evaluations == 0, "Expected no evaluation, but got: " << Connectivity::getStatistics().toString());
+        BOOST_REQUIRE_MESSAGE(baseGraph && baseGraph->isConnected(), "Expected connected graph");
+        BOOST_REQUIRE_MESSAGE(baseGraph->getAllVertices().size() == 10, "Expected 10 agents in the connection graph");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(connectivity_enumeration)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    OrganizationModelAsk ask(om);
+
+    ModelPool modelPool;
+    modelPool[vocabulary::OM::resolve("Payload")] = 3;
+
+    ConnectivityEnumerator enumerator(modelPool, ask);
+    ConnectivityWitness witness;
+    while(enumerator.next(witness, 10000))
+    {
+        BOOST_REQUIRE_MESSAGE(witness.getNumberOfAgents() == 3, "Expected 3 agents: " << witness.toString());
+        BOOST_REQUIRE_MESSAGE(witness.getLinks().size() == 2, "Expected a tree: " << witness.toString());
+        BOOST_REQUIRE_MESSAGE(witness.toBaseGraph()->isConnected(), "Expected connected graph: " << witness.toString());
+    }
+    BOOST_REQUIRE_MESSAGE(enumerator.isExhausted(), "Expected enumeration to be complete");
+    BOOST_REQUIRE_MESSAGE(enumerator.getNumberOfTopologies() > 0, "Expected at least one topology");
+    BOOST_REQUIRE_MESSAGE(!enumerator.next(witness), "Expected no further topology");
+}
+
+BOOST_AUTO_TEST_CASE(connectivity_enumeration_single_model)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    OrganizationModelAsk ask(om);
+
+    ModelPool modelPool;
+    modelPool[vocabulary::OM::resolve("Payload")] = 3;
+
+    typedef std::vector< std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> > LinkList;
+    // Links of the witness after renaming the agents
+    auto getLinks = [](const ConnectivityWitness& witness, const std::vector<uint32_t>& agents)
+    {
+        LinkList links;
+        for(const ConnectivityWitness::Link& link : witness.getLinks())
+        {
+            uint32_t agent0 = agents[link.agent0];
+            uint32_t agent1 = agents[link.agent1];
+            if(agent0 < agent1)
+            {
+                links.push_back( std::make_tuple(agent0, link.interface0, agent1, link.interface1) );
+            } else {
+                links.push_back( std::make_tuple(agent1, link.interface1, agent0, link.interface0) );
+            }
+        }
+        std::sort(links.begin(), links.end());
+        return links;
+    };
+
+    std::set<LinkList> topologies;
+    std::set<LinkList> canonicalTopologies;
+    ConnectivityEnumerator enumerator(modelPool, ask);
+    ConnectivityWitness witness;
+    while(enumerator.next(witness, 10000))
+    {
+        std::vector<uint32_t> agents = { 0, 1, 2 };
+        BOOST_REQUIRE_MESSAGE(topologies.insert(getLinks(witness, agents)).second, "Expected a new topology: " << witness.toString());
+
+        // All agents are interchangeable, so the minimum over all renamings
+        // identifies the topology up to symmetry
+        LinkList canonical = getLinks(witness, agents);
+        while(std::next_permutation(agents.begin(), agents.end()))
+        {
+            canonical = std::min(canonical, getLinks(witness, agents));
+        }
+        canonicalTopologies.insert(canonical);
+    }
+    BOOST_REQUIRE_MESSAGE(enumerator.isExhausted(), "Expected enumeration to be complete");
+    BOOST_REQUIRE_MESSAGE(topologies.size() == enumerator.getNumberOfTopologies(), "Expected distinct topologies only");
+    BOOST_REQUIRE_MESSAGE(!canonicalTopologies.empty(), "Expected at least one topology up to symmetry");
+    // Symmetric solutions are reduced, but not eliminated
+    BOOST_REQUIRE_MESSAGE(canonicalTopologies.size() <= topologies.size(),
+            "Expected at most " << topologies.size() << " topologies up to symmetry, got " << canonicalTopologies.size());
+    BOOST_TEST_MESSAGE("Topologies: " << topologies.size() << ", up to symmetry: " << canonicalTopologies.size());
+}
+
+BOOST_AUTO_TEST_CASE(connectivity_delta)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+    OrganizationModelAsk ask(om);
+
+    owlapi::model::IRI payload = vocabulary::OM::resolve("Payload");
+    ModelPool basePool;
+    basePool[payload] = 3;
+
+    ConnectivityWitness baseWitness;
+    ConnectivityEnumerator enumerator(basePool, ask);
+    BOOST_REQUIRE_MESSAGE(enumerator.next(baseWitness), "Expected a topology for: " << basePool.toString());
+
+    {
+        ModelPoolDelta delta;
+        delta[payload] = -1;
+        ConnectivityWitness witness;
+        BOOST_REQUIRE_MESSAGE(Connectivity::isFeasibleDelta(basePool, baseWitness, delta, ask, witness), "Expected removal to be feasible");
+        BOOST_REQUIRE_MESSAGE(witness.getNumberOfAgents() == 2 && witness.isConnected(), "Expected connected witness: " << witness.toString());
+        BOOST_REQUIRE_MESSAGE(Connectivity::getStatistics().csp.node == 0, "Expected local repair without search");
+    }
+    {
+        ModelPoolDelta delta;
+        delta[payload] = 2;
+        ConnectivityWitness witness;
+        BOOST_REQUIRE_MESSAGE(Connectivity::isFeasibleDelta(basePool, baseWitness, delta, ask, witness), "Expected addition to be feasible");
+        BOOST_REQUIRE_MESSAGE(witness.getNumberOfAgents() == 5 && witness.isConnected(), "Expected connected witness: " << witness.toString());
+    }
+    {
+        ModelPoolDelta delta;
+        delta[payload] = -4;
+        ConnectivityWitness witness;
+        BOOST_REQUIRE_THROW(Connectivity::isFeasibleDelta(basePool, baseWitness, delta, ask, witness), std::invalid_argument);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(connectivity_statistics)
+{
+    std::vector<Connectivity::Statistics> statistics;
+    for(size_t i = 1; i <= 5; ++i)
+    {
+        Connectivity::Statistics s;
+        s.evaluations = i;
+        s.csp.node = 10*i;
+        statistics.push_back(s);
+    }
+
+    std::vector<double> median = Connectivity::Statistics::compute(statistics, 0.5);
+    BOOST_REQUIRE_MESSAGE(median[0] == 3, "Expected median of evaluations 3, but got " << median[0]);
+    BOOST_REQUIRE_MESSAGE(median[5] == 30, "Expected median of expanded nodes 30, but got " << median[5]);
+
+    std::vector<double> percentile = Connectivity::Statistics::compute(statistics, 0.9);
+    BOOST_REQUIRE_CLOSE(percentile[0], 4.6, 1e-6);
+    BOOST_REQUIRE_THROW(Connectivity::Statistics::compute(statistics, 1.5), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(subset_superset)
 {
     ModelPool modelPoolA;
@@ -2,6 +2,7 @@
 #include "test_utils.hpp"
 
 #include <moreorg/ccf/CCF.hpp>
+#include <moreorg/ccf/SpanningTreeEnumeration.hpp>
 #include <moreorg/OrganizationModel.hpp>
 #include <set>
 
@@ -34,6 +35,31 @@ BOOST_AUTO_TEST_CASE(handle_sets)
 
 }
 
+BOOST_AUTO_TEST_CASE(handle_bitset_sets)
+{
+    Set<uint8_t> set;
+    set.insert(3);
+    set.insert(200);
+    set.insert(64);
+    BOOST_REQUIRE_MESSAGE( set.size() == 3, "Set of size 3: " << set.toString());
+    BOOST_REQUIRE_MESSAGE( set.toString() == "{3,64,200}", "Items are ordered: " << set.toString());
+    BOOST_REQUIRE_MESSAGE( !set.insert(64), "Item is inserted only once");
+
+    Set<uint8_t> subset(64);
+    BOOST_REQUIRE_MESSAGE( set.isSupersetOf(subset), "Superset of " << subset.toString());
+    BOOST_REQUIRE_MESSAGE( set.without(64).toString() == "{3,200}", "Remove item: " << set.without(64).toString());
+
+    // The order has to match the lexicographical order of the generic set
+    Set<int> intSet;
+    intSet.insert(3);
+    intSet.insert(200);
+    intSet.insert(64);
+    Set<int> intSubset(64);
+    BOOST_REQUIRE( (set < subset) == (intSet < intSubset) );
+    BOOST_REQUIRE( (subset < set) == (intSubset < intSet) );
+    BOOST_REQUIRE( (set.without(200) < set) == (intSet.without(200) < intSet) );
+}
+
 BOOST_AUTO_TEST_CASE(handle_reference_ccf)
 {
 
@@ -164,6 +190,126 @@ BOOST_AUTO_TEST_CASE(compute_coalitions)
             BOOST_TEST_MESSAGE("Feasible coalition structure: " << structure.toString());
         }
     }
+    {
+        // Same scenario with numbered links
+        CCF<uint8_t>::Atoms atoms;
+        for(uint8_t link = 0; link < 3; ++link)
+        {
+            atoms.insert(link);
+        }
+
+        CCF<uint8_t> ccf(atoms);
+        for(uint8_t atom : atoms)
+        {
+            ccf.addPositiveConstraint( CCF<uint8_t>::Constraint(atom));
+        }
+
+        CCF<uint8_t>::Constraint constraint;
+        constraint.insert(0);
+        constraint.insert(1);
+        ccf.addNegativeConstraint(constraint);
+
+        CCF<uint8_t>::Coalitions coalitions;
+        CCF<uint8_t>::AStar aStar = ccf.computeConstrainedCoalitions(coalitions);
+        BOOST_REQUIRE_MESSAGE(coalitions.size() == 3, "Coalitions: " << coalitions.toString());
+
+        CCF<uint8_t>::CoalitionsList list = ccf.createLists(aStar, coalitions);
+        std::vector< CCF<uint8_t>::Coalitions > feasibleCoalitionStructure;
+        ccf.computeFeasibleCoalitions(list, feasibleCoalitionStructure);
+        BOOST_REQUIRE_MESSAGE(feasibleCoalitionStructure.size() == 1, "Feasible coalition structures: " << feasibleCoalitionStructure.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(compute_coalitions_in_parallel)
+{
+    size_t numberOfAtoms = 12;
+    CCF<uint8_t>::Atoms atoms;
+    for(uint8_t atom = 0; atom < numberOfAtoms; ++atom)
+    {
+        atoms.insert(atom);
+    }
+
+    std::vector< CCF<uint8_t>::Coalitions > coalitions;
+    std::vector< CCF<uint8_t>::AStar > aStars;
+    std::vector< std::vector<CCF<uint8_t>::Coalitions> > coalitionStructures;
+    for(size_t numberOfThreads : { 1, 4 })
+    {
+        CCF<uint8_t> ccf(atoms);
+        ccf.setNumberOfThreads(numberOfThreads);
+        ccf.setParallelCutoff(2);
+        for(uint8_t atom = 0; atom < numberOfAtoms; ++atom)
+        {
+            ccf.addPositiveConstraint( CCF<uint8_t>::Constraint(atom) );
+
+            CCF<uint8_t>::Constraint positive;
+            positive.insert(atom);
+            positive.insert( (atom + 5) % numberOfAtoms );
+            ccf.addPositiveConstraint(positive);
+
+            if(atom % 3 == 0)
+            {
+                CCF<uint8_t>::Constraint negative;
+                negative.insert(atom);
+                negative.insert( (atom + 1) % numberOfAtoms );
+                ccf.addNegativeConstraint(negative);
+            }
+        }
+
+        CCF<uint8_t>::Coalitions c;
+        CCF<uint8_t>::AStar aStar = ccf.computeConstrainedCoalitions(c);
+        CCF<uint8_t>::CoalitionsList list = ccf.createLists(aStar, c);
+        std::vector<CCF<uint8_t>::Coalitions> structures;
+        ccf.computeFeasibleCoalitions(list, structures);
+
+        coalitions.push_back(c);
+        aStars.push_back(aStar);
+        coalitionStructures.push_back(structures);
+    }
+
+    BOOST_REQUIRE_MESSAGE(coalitions[0].toString() == coalitions[1].toString(), "Coalitions: serial " << coalitions[0].toString() << " vs. parallel " << coalitions[1].toString());
+    BOOST_REQUIRE_MESSAGE(aStars[0] == aStars[1], "AStar of serial and parallel exploration are equal");
+    BOOST_REQUIRE_MESSAGE(coalitionStructures[0].size() == coalitionStructures[1].size(), "Number of feasible coalition structures: serial " << coalitionStructures[0].size() << " vs. parallel " << coalitionStructures[1].size());
+    for(size_t i = 0; i < coalitionStructures[0].size(); ++i)
+    {
+        BOOST_REQUIRE_MESSAGE(coalitionStructures[0][i].toString() == coalitionStructures[1][i].toString(), "Feasible coalition structure: serial " << coalitionStructures[0][i].toString() << " vs. parallel " << coalitionStructures[1][i].toString());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(enumerate_spanning_trees)
+{
+    using namespace multiagent::ccf;
+
+    std::vector<Actor> actors;
+    actors.push_back( Actor('a',0) );
+    actors.push_back( Actor('b',0) );
+    actors.push_back( Actor('c',0) );
+
+    // Links per pair of actors: a-b: 2, b-c: 3, a-c: 1
+    std::map<LinkGroup, std::set<Link> > linkGroupMap;
+    std::vector< std::pair<size_t, size_t> > pairs = { {0,1}, {0,1}, {1,2}, {1,2}, {1,2}, {0,2} };
+    LocalInterfaceId interfaceId = 0;
+    for(const std::pair<size_t, size_t>& p : pairs)
+    {
+        Link link( Interface(actors[p.first], interfaceId, 'm'), Interface(actors[p.second], interfaceId, 'f') );
+        linkGroupMap[link.getGroup()].insert(link);
+        ++interfaceId;
+    }
+
+    SpanningTreeEnumeration enumeration(actors, linkGroupMap);
+    std::set< std::set<LinkGroup> > trees;
+    uint64_t numberOfLinkSets = enumeration.enumerate([&trees](const std::vector<LinkGroup>& tree, uint64_t)
+            {
+                trees.insert( std::set<LinkGroup>(tree.begin(), tree.end()) );
+            });
+
+    BOOST_REQUIRE_MESSAGE(enumeration.getNumberOfTrees() == 3, "Spanning trees of the triangle: " << enumeration.getNumberOfTrees());
+    BOOST_REQUIRE_MESSAGE(trees.size() == 3, "Each tree is enumerated once");
+    BOOST_REQUIRE_MESSAGE(numberOfLinkSets == 2*3 + 2*1 + 3*1, "Link sets: " << numberOfLinkSets);
+
+    // A fourth actor without links cannot be connected
+    actors.push_back( Actor('d',0) );
+    SpanningTreeEnumeration disconnected(actors, linkGroupMap);
+    BOOST_REQUIRE_MESSAGE(disconnected.enumerate() == 0, "No link sets for disconnected actors");
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,7 @@
 #include <moreorg/vocabularies/OM.hpp>
 #include <moreorg/ResourceInstance.hpp>
 #include <moreorg/reasoning/ResourceInstanceMatch.hpp>
+#include <moreorg/reasoning/SupportTable.hpp>
 #include <moreorg/Agent.hpp>
 
 #include "test_utils.hpp"
@@ -103,6 +104,64 @@ BOOST_AUTO_TEST_CASE(match_resource_via_restrictions)
     BOOST_TEST_MESSAGE("Solution:" << solution.toString());
 }
 
+BOOST_AUTO_TEST_CASE(match_resource_max_flow)
+{
+    OWLOntology::Ptr ontology = make_shared<OWLOntology>();
+    OWLOntologyTell tell(ontology);
+    tell.initializeDefaultClasses();
+
+    OWLClass::Ptr a = tell.klass("http://klass/base");
+    OWLClass::Ptr b = tell.klass("http://klass/base-derived");
+    OWLClass::Ptr c = tell.klass("http://klass/base-derived-derived");
+
+    tell.subClassOf(c,b);
+    tell.subClassOf(b,a);
+    ontology->refresh();
+
+    ModelBound::List available;
+    available.push_back(ModelBound(b->getIRI(), 3, 3));
+    available.push_back(ModelBound(c->getIRI(), 3, 3));
+
+    for(uint32_t n = 0; n < 5; ++n)
+    {
+        ModelBound::List required;
+        required.push_back(ModelBound(a->getIRI(), 2, 2));
+        required.push_back(ModelBound(c->getIRI(), n, n));
+
+        bool feasible = true;
+        ResourceMatch::Solution solution;
+        try {
+            solution = ResourceMatch::solve(required, available, ontology);
+        } catch(const std::runtime_error& e)
+        {
+            feasible = false;
+        }
+
+        bool feasibleCSP = true;
+        try {
+            ResourceMatch::solveCSP(required, available, ontology);
+        } catch(const std::runtime_error& e)
+        {
+            feasibleCSP = false;
+        }
+
+        BOOST_REQUIRE_MESSAGE(feasible == feasibleCSP, "Max-flow and CSP differ for " << n << " required instances of C");
+        BOOST_REQUIRE_MESSAGE(feasible == (n <= 3), "Expected " << n << " instances of C to be "
+                << (n <= 3 ? "feasible" : "infeasible"));
+        if(feasible && n > 0)
+        {
+            uint32_t assigned = 0;
+            for(const ModelBound& modelBound : solution.getAssignments(c->getIRI()))
+            {
+                BOOST_REQUIRE_MESSAGE(modelBound.model == c->getIRI(), "Expected only C to be assigned to C, but got "
+                        << modelBound.toString());
+                assigned += modelBound.min;
+            }
+            BOOST_REQUIRE_MESSAGE(assigned == n, "Expected " << n << " assigned instances of C, but got " << assigned);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(provider_via_restrictions)
 {
     OWLOntology::Ptr ontology = io::OWLOntologyIO::fromFile( getOMSchema() );
@@ -256,6 +315,53 @@ BOOST_AUTO_TEST_CASE(provider_via_restrictions)
 
 }
 
+BOOST_AUTO_TEST_CASE(support_table)
+{
+    OWLOntology::Ptr ontology = io::OWLOntologyIO::fromFile( getOMSchema() );
+    ontology->refresh();
+
+    IRI sherpa = moreorg::vocabulary::OM::resolve("Sherpa");
+    IRI crex = moreorg::vocabulary::OM::resolve("CREX");
+
+    owlapi::model::IRIList serviceModels;
+    serviceModels.push_back(moreorg::vocabulary::OM::resolve("MoveTo"));
+    serviceModels.push_back(moreorg::vocabulary::OM::resolve("ImageProvider"));
+    serviceModels.push_back(moreorg::vocabulary::OM::resolve("StereoImageProvider"));
+    serviceModels.push_back(moreorg::vocabulary::OM::resolve("LocationImageProvider"));
+
+    owlapi::model::IRIList combination;
+    combination.push_back(sherpa);
+
+    ModelPool modelPool;
+    modelPool[sherpa] = 1;
+    modelPool[crex] = 2;
+
+    // Reference results without table
+    SupportTable::clear(ontology);
+    owlapi::model::IRIList expectedPool = ResourceMatch::filterSupportedModels(modelPool, serviceModels, ontology);
+    SupportTable::clear(ontology);
+    owlapi::model::IRIList expectedSherpa = ResourceMatch::filterSupportedModels(combination, serviceModels, ontology);
+    SupportTable::clear(ontology);
+
+    ResourceMatch::prepareSupportTable(modelPool, serviceModels, ontology);
+    size_t numberOfEntries = SupportTable::getInstance(ontology)->size();
+    BOOST_REQUIRE_MESSAGE(numberOfEntries > 0, "Support table should be prepared");
+
+    BOOST_REQUIRE_MESSAGE(ResourceMatch::filterSupportedModels(modelPool, serviceModels, ontology) == expectedPool,
+            "Supported models of the model pool differ when using the support table");
+    BOOST_REQUIRE_MESSAGE(ResourceMatch::filterSupportedModels(combination, serviceModels, ontology) == expectedSherpa,
+            "Supported models of sherpa differ when using the support table");
+    BOOST_REQUIRE_MESSAGE(SupportTable::getInstance(ontology)->size() == numberOfEntries,
+            "Lookups for prepared models should not add entries");
+
+    for(const IRI& serviceModel : serviceModels)
+    {
+        bool supported = std::find(expectedSherpa.begin(), expectedSherpa.end(), serviceModel) != expectedSherpa.end();
+        BOOST_REQUIRE_MESSAGE(ResourceMatch::isSupporting(sherpa, serviceModel, ontology) == supported,
+                "Support of " << serviceModel << " by sherpa differs when using the support table");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(resource_instance_matching)
 {
     using namespace moreorg::reasoning;
@@ -290,6 +396,29 @@ BOOST_AUTO_TEST_CASE(resource_instance_matching)
     }
 }
 
+BOOST_AUTO_TEST_CASE(compiled_resource_instance_matching)
+{
+    OrganizationModel::Ptr om = make_shared<OrganizationModel>(getRootDir() + "/test/data/om-project-transterra.owl");
+    OrganizationModelAsk ask(om);
+
+    IRI sherpa = moreorg::vocabulary::OM::resolve("Sherpa");
+    IRI move_to = moreorg::vocabulary::OM::resolve("MoveTo");
+
+    Agent agent;
+    AtomicAgent sherpa_0(0,sherpa);
+    agent.add(sherpa_0);
+
+    std::vector<OWLCardinalityRestriction::Ptr> required =
+        ask.ontology().getCardinalityRestrictions(move_to);
+    ModelBound::List requiredModelBound = ResourceInstanceMatch::toModelBoundList(required);
+    ResourceInstance::List available = ask.getRelated(agent);
+
+    ResourceInstanceMatch::Compiled match(requiredModelBound, available, ask);
+    BOOST_REQUIRE_NO_THROW(match.solve(std::vector<bool>(available.size(), true)));
+    BOOST_REQUIRE_THROW(match.solve(std::vector<bool>(available.size(), false)), std::runtime_error);
+    BOOST_REQUIRE_THROW(match.solve(std::vector<bool>(available.size() + 1, true)), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(performance_three_sherpa)
 {
     OWLOntology::Ptr ontology = io::OWLOntologyIO::fromFile( getRootDir() + "/test/data/om-schema-v0.6.owl");
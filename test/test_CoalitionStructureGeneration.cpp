@@ -131,3 +131,74 @@ BOOST_AUTO_TEST_CASE(it_should_compute_csg_anytime)
     }
     BOOST_TEST_MESSAGE("Final result: " << CoalitionStructureGeneration::toString(csg.currentBestSolution()) << ", value: " << coalitionStructureValueFunction(csg.currentBestSolution()) );
 }
+
+BOOST_AUTO_TEST_CASE(it_should_enumerate_bitmask_coalitions)
+{
+    namespace bitmask = moreorg::utils::bitmask;
+    using moreorg::utils::Bitmask;
+
+    // Gosper's hack enumerates all coalitions of size 2 out of 5 agents
+    size_t count = 0;
+    Bitmask end = Bitmask(1) << 5;
+    for(Bitmask m = bitmask::first(2); m < end; m = bitmask::next(m))
+    {
+        BOOST_REQUIRE_MESSAGE(bitmask::count(m) == 2, "Coalition has size 2");
+        ++count;
+    }
+    BOOST_REQUIRE_MESSAGE(count == 10, "10 coalitions of size 2 out of 5 agents, found " << count);
+
+    // select the first and third of the agents {1,3,4}
+    BOOST_REQUIRE_EQUAL(bitmask::deposit(0x5, 0x1A), Bitmask(0x12));
+
+    AgentList agents = { "a", "b", "c", "d" };
+    AgentList coalition = { "b", "d" };
+    Bitmask mask = bitmask::fromList(coalition, agents);
+    BOOST_REQUIRE_EQUAL(mask, Bitmask(0xA));
+    BOOST_REQUIRE_MESSAGE(bitmask::toList(mask, agents) == coalition, "Bitmask maps back to coalition");
+}
+
+BOOST_AUTO_TEST_CASE(it_should_compute_csg_with_bitmasks)
+{
+    AgentList agents = { "a", "b", "c", "d", "e" };
+    CoalitionStructureGeneration csg(agents, coalitionValueFunction, coalitionStructureValueFunction);
+    CoalitionStructure cs = csg.findBest(1.0);
+    BOOST_REQUIRE_MESSAGE(coalitionStructureValueFunction(cs) == 700, "Best coalition structure has value 700: "
+            << CoalitionStructureGeneration::toString(cs));
+    BOOST_REQUIRE_MESSAGE(csg.currentBestSolutionValue() == 700, "Best solution value is 700");
+
+    AgentList tooManyAgents;
+    for(size_t i = 0; i < 64; ++i)
+    {
+        tooManyAgents.push_back( std::to_string(i) );
+    }
+    BOOST_REQUIRE_THROW(CoalitionStructureGeneration(tooManyAgents, coalitionValueFunction, coalitionStructureValueFunction), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_compute_csg_with_dynamic_programming)
+{
+    AgentList agents;
+    for(char a = 'a'; a < 'a' + 8; ++a)
+    {
+        agents.push_back(std::string(1, a));
+    }
+
+    CoalitionStructureGeneration ip(agents, coalitionValueFunction, coalitionStructureValueFunction);
+    CoalitionStructure ipStructure = ip.findBest(1.0);
+
+    CoalitionStructureGeneration dp(agents, coalitionValueFunction, coalitionStructureValueFunction);
+    CoalitionStructure dpStructure = dp.findBestDP(4);
+    BOOST_REQUIRE_MESSAGE(coalitionStructureValueFunction(dpStructure) == coalitionStructureValueFunction(ipStructure), "Dynamic programming finds the optimal coalition structure: "
+            << CoalitionStructureGeneration::toString(dpStructure) << " vs. " << CoalitionStructureGeneration::toString(ipStructure));
+    BOOST_REQUIRE_MESSAGE(dp.currentBestSolutionQuality() == 1.0, "Solution of dynamic programming is optimal");
+
+    size_t numberOfAssignedAgents = 0;
+    for(const Coalition& coalition : dpStructure)
+    {
+        numberOfAssignedAgents += coalition.size();
+    }
+    BOOST_REQUIRE_MESSAGE(numberOfAssignedAgents == agents.size(), "All agents are assigned to one coalition");
+
+    CoalitionStructureGeneration optimal(agents, coalitionValueFunction, coalitionStructureValueFunction);
+    CoalitionStructure optimalStructure = optimal.findOptimal(1);
+    BOOST_REQUIRE_MESSAGE(optimal.currentBestSolutionValue() == dp.currentBestSolutionValue(), "findOptimal uses dynamic programming for few agents");
+}
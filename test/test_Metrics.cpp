@@ -3,6 +3,7 @@
 
 #include <moreorg/OrganizationModel.hpp>
 #include <moreorg/metrics/Redundancy.hpp>
+#include <moreorg/reasoning/ResourceMatch.hpp>
 #include <moreorg/vocabularies/OM.hpp>
 #include <owlapi/model/OWLOntologyAsk.hpp>
 #include <owlapi/model/OWLOntologyTell.hpp>
@@ -129,6 +130,101 @@ BOOST_FIXTURE_TEST_CASE(redundancy_same_parallel_in_series, RedundancyFixture)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(redundancy_full_model_count, RedundancyFixture)
+{
+    using namespace moreorg::reasoning;
+
+    OrganizationModelAsk ask(om);
+    metrics::Redundancy redundancy(ask, 0.5, has);
+
+    IRI iriA("http://klass/base");
+    IRI iriB("http://klass/base-derived");
+    IRI iriC("http://klass/base-derived-derived");
+
+    std::vector< std::pair<ModelBound::List, ModelBound::List> > problems;
+    // required: =2.has.A and =2.has.C, available: =2.has.B and =2.has.C
+    problems.push_back(std::make_pair(
+                ModelBound::List({ ModelBound(iriA, 2, 2), ModelBound(iriC, 2, 2) }),
+                ModelBound::List({ ModelBound(iriB, 2, 2), ModelBound(iriC, 2, 2) })));
+    // required: =2.has.A, available: =4.has.A
+    problems.push_back(std::make_pair(
+                ModelBound::List({ ModelBound(iriA, 2, 2) }),
+                ModelBound::List({ ModelBound(iriA, 4, 4) })));
+    // required: =1.has.B, available: =3.has.C
+    problems.push_back(std::make_pair(
+                ModelBound::List({ ModelBound(iriB, 1, 1) }),
+                ModelBound::List({ ModelBound(iriC, 3, 3) })));
+    // required: =2.has.C, available: =3.has.B
+    problems.push_back(std::make_pair(
+                ModelBound::List({ ModelBound(iriC, 2, 2) }),
+                ModelBound::List({ ModelBound(iriB, 3, 3) })));
+
+    std::vector<uint32_t> expectedCounts = { 1, 2, 3, 0 };
+    for(size_t i = 0; i < problems.size(); ++i)
+    {
+        const ModelBound::List& required = problems[i].first;
+        const ModelBound::List& available = problems[i].second;
+
+        ModelBound::List remaining;
+        ModelBound::List remainingIterative;
+        uint32_t count = redundancy.computeFullModelRedundancy(required, available, remaining);
+        uint32_t countIterative = redundancy.computeFullModelRedundancy(required, available, remainingIterative, true);
+
+        BOOST_REQUIRE_MESSAGE(count == expectedCounts[i], "Problem #" << i << ": expected count "
+                << expectedCounts[i] << " but got " << count);
+        BOOST_REQUIRE_MESSAGE(count == countIterative, "Problem #" << i << ": closed-form count "
+                << count << " differs from iterative count " << countIterative);
+
+        BOOST_REQUIRE_MESSAGE(remaining.size() == remainingIterative.size(), "Problem #" << i << ": remaining differs");
+        for(size_t r = 0; r < remaining.size(); ++r)
+        {
+            BOOST_REQUIRE_MESSAGE(remaining[r].model == remainingIterative[r].model
+                    && remaining[r].min == remainingIterative[r].min
+                    && remaining[r].max == remainingIterative[r].max,
+                    "Problem #" << i << ": remaining " << remaining[r].toString()
+                    << " differs from iterative " << remainingIterative[r].toString());
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(redundancy_full_model_count_subclasses, RedundancyFixture)
+{
+    using namespace moreorg::reasoning;
+
+    OrganizationModelAsk ask(om);
+    metrics::Redundancy redundancy(ask, 0.5, has);
+
+    IRI iriB("http://klass/base-derived");
+    IRI iriC("http://klass/base-derived-derived");
+
+    // A subclass resource can fulfill a superclass requirement, but must be
+    // counted only once
+    // required: =1.has.B, available: =1.has.B and =2.has.C
+    ModelBound::List required({ ModelBound(iriB, 1, 1) });
+    ModelBound::List available({ ModelBound(iriB, 1, 1), ModelBound(iriC, 2, 2) });
+
+    ModelBound::List remaining;
+    uint32_t count = ResourceMatch::getMaxNumberOfAssignments(required, available, om->ontology(), &remaining);
+    BOOST_REQUIRE_MESSAGE(count == 3, "Expected count 3, i.e. one per available resource, but got " << count);
+    BOOST_REQUIRE_MESSAGE(redundancy.computeFullModelRedundancy(required, available, remaining) == 3,
+            "Redundancy uses the same count");
+
+    BOOST_REQUIRE_EQUAL(remaining.size(), 2);
+    for(const ModelBound& modelBound : remaining)
+    {
+        BOOST_REQUIRE_MESSAGE(modelBound.min == 0 && modelBound.max == 0, "All resources are used, but remaining "
+                << modelBound.toString());
+    }
+
+    // required: =1.has.C and =1.has.B, available: =2.has.B and =2.has.C,
+    // where C can only be fulfilled by C
+    required = ModelBound::List({ ModelBound(iriC, 1, 1), ModelBound(iriB, 1, 1) });
+    available = ModelBound::List({ ModelBound(iriB, 2, 2), ModelBound(iriC, 2, 2) });
+    count = ResourceMatch::getMaxNumberOfAssignments(required, available, om->ontology(), &remaining);
+    BOOST_REQUIRE_MESSAGE(count == 2, "Expected count 2, but got " << count);
+    BOOST_REQUIRE_MESSAGE(remaining[0].max == 0 && remaining[1].max == 0, "Each resource has been charged once");
+}
+
 BOOST_AUTO_TEST_CASE(redundancy_computation)
 {
     OrganizationModel om(getRootDir() + "/test/data/om-project-transterra.owl");
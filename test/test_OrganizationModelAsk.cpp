@@ -11,6 +11,8 @@
 #include <moreorg/ResourceInstance.hpp>
 #include <moreorg/facades/Robot.hpp>
 #include <moreorg/Agent.hpp>
+#include <moreorg/utils/OrganizationStructureGeneration.hpp>
+#include <moreorg/algebra/Connectivity.hpp>
 
 using namespace moreorg;
 using namespace moreorg::reasoning;
@@ -616,6 +618,81 @@ BOOST_AUTO_TEST_CASE(organization_structure_generation)
         BOOST_REQUIRE_MESSAGE(!csg.empty(), "Found feasible coalition structure for transport for " << modelPool.toString(4));
     }
 
+    {
+        // Parallel evaluation of the coalitions, where the feasibility of
+        // coalitions is cached by algebra::Connectivity
+        ModelPool modelPool;
+        modelPool[sherpa] = 1;
+        modelPool[payload] = 3;
+        modelPool[coyote] = 3;
+
+        OrganizationModelAsk ask(om, modelPool, true);
+
+        Resource::Set resources;
+        resources.insert( Resource( OM::resolve("MoveTo") ) );
+
+        // A valid coalition structure covers the model pool with feasible
+        // coalitions that support the resources
+        auto isValid = [&ask, &modelPool, &resources](const ModelPool::List& csg)
+            {
+                ModelPool combined;
+                for(const ModelPool& coalition : csg)
+                {
+                    for(const Resource& resource : resources)
+                    {
+                        if(!ask.isSupporting(coalition, resource))
+                        {
+                            return false;
+                        }
+                    }
+                    if(!ask.isFeasible(coalition, 1))
+                    {
+                        return false;
+                    }
+                    for(const ModelPool::value_type& v : coalition)
+                    {
+                        combined[v.first] += v.second;
+                    }
+                }
+                return combined == modelPool;
+            };
+
+        algebra::Connectivity::resetQueryCache();
+        ModelPool::List parallelCsg = ask.findFeasibleCoalitionStructure(modelPool,
+                resources,
+                1,
+                4);
+        size_t cachedFeasibility = algebra::Connectivity::getQueryCacheSize();
+        BOOST_REQUIRE_MESSAGE(cachedFeasibility > 0, "Feasibility of coalitions has been cached");
+
+        // Results of coalition structure queries are cached as well
+        om->resetQueryCache();
+        ModelPool::List serialCsg = ask.findFeasibleCoalitionStructure(modelPool,
+                resources,
+                1,
+                1);
+        BOOST_REQUIRE_MESSAGE(algebra::Connectivity::getQueryCacheSize() == cachedFeasibility,
+                "Serial search reuses the cached feasibility of the parallel search");
+        BOOST_REQUIRE_MESSAGE(!serialCsg.empty(), "Found feasible coalition structure for transport for " << modelPool.toString(4));
+        BOOST_REQUIRE_MESSAGE(parallelCsg.empty() == serialCsg.empty(), "Parallel and serial search find a coalition structure");
+        // Coalition structures of the same value might be found in a
+        // different order, so that both have to be equally valid
+        BOOST_REQUIRE_MESSAGE(isValid(serialCsg), "Serial search finds a valid coalition structure");
+        BOOST_REQUIRE_MESSAGE(isValid(parallelCsg), "Parallel search finds a valid coalition structure");
+
+        // Coalitions which support more resources are a subset of the ones
+        // checked before, so that no new feasibility check is required
+        Resource::Set otherResources = resources;
+        otherResources.insert( Resource( OM::resolve("StereoImageProvider") ) );
+        ask.findFeasibleCoalitionStructure(modelPool,
+                otherResources,
+                1,
+                4);
+        BOOST_REQUIRE_MESSAGE(algebra::Connectivity::getQueryCacheSize() == cachedFeasibility,
+                "Query for another resource set reuses the cached feasibility: "
+                << algebra::Connectivity::getQueryCacheSize() << " cached, expected " << cachedFeasibility);
+    }
+
     {
         ModelPool modelPool;
         modelPool[payload] = 4;
@@ -651,6 +728,49 @@ BOOST_AUTO_TEST_CASE(organization_structure_generation)
     }
 }
 
+BOOST_AUTO_TEST_CASE(organization_structure_generation_parallel_cold_cache)
+{
+    IRI sherpa = OM::resolve("Sherpa");
+    IRI payload = OM::resolve("Payload");
+    IRI coyote = OM::resolve("CoyoteIII");
+
+    ModelPool modelPool;
+    modelPool[sherpa] = 1;
+    modelPool[payload] = 3;
+    modelPool[coyote] = 3;
+
+    Resource::Set resources;
+    resources.insert( Resource( OM::resolve("MoveTo") ) );
+
+    // Each organization model starts without interface compatibility
+    // tables, and the cleared query cache and witness library require
+    // the feasibility checks of the parallel search to query the ontology
+    for(size_t numberOfThreads : { 4, 1 })
+    {
+        OrganizationModel::Ptr om = make_shared<OrganizationModel>(getOMSchema());
+        OrganizationModelAsk ask(om, modelPool, true);
+        algebra::Connectivity::resetQueryCache();
+
+        ModelPool::List csg = ask.findFeasibleCoalitionStructure(modelPool,
+                resources,
+                1,
+                numberOfThreads);
+        BOOST_REQUIRE_MESSAGE(!csg.empty(), "Found feasible coalition structure using " << numberOfThreads << " threads");
+
+        ModelPool combined;
+        for(const ModelPool& coalition : csg)
+        {
+            BOOST_REQUIRE_MESSAGE(ask.isSupporting(coalition, *resources.begin()), "Coalition supports the resources: " << coalition.toString(4));
+            BOOST_REQUIRE_MESSAGE(ask.isFeasible(coalition, 1), "Coalition is feasible: " << coalition.toString(4));
+            for(const ModelPool::value_type& v : coalition)
+            {
+                combined[v.first] += v.second;
+            }
+        }
+        BOOST_REQUIRE_MESSAGE(combined == modelPool, "Coalition structure covers the model pool");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(organization_structure_generation_vrp)
 {
     using namespace owlapi::vocabulary;
@@ -680,6 +800,279 @@ BOOST_AUTO_TEST_CASE(organization_structure_generation_vrp)
     }
 }
 
+/**
+ * Payloads of the weights 1..numberOfPayloads and sherpas, where a coalition
+ * requires a single sherpa, which should carry the given target weight. The
+ * value of a coalition structure is the minimum value of its coalitions
+ */
+struct WeightedPayloads
+{
+    AtomicAgent::List agents;
+    utils::CoalitionStructureGeneration::CoalitionValueFunction coalitionValue;
+    utils::CoalitionStructureGeneration::CoalitionStructureValueFunction structureValue;
+
+    WeightedPayloads(size_t numberOfPayloads, size_t numberOfSherpas, double targetWeight)
+    {
+        IRI sherpa = OM::resolve("Sherpa");
+
+        std::map<IRI, size_t> weights;
+        for(size_t i = 1; i <= numberOfPayloads; ++i)
+        {
+            IRI payload = OM::resolve("Payload" + std::to_string(i));
+            weights[payload] = i;
+            agents.push_back(AtomicAgent(0, payload));
+        }
+        for(size_t i = 0; i < numberOfSherpas; ++i)
+        {
+            agents.push_back(AtomicAgent(i, sherpa));
+        }
+
+        coalitionValue = [sherpa, weights, targetWeight](const AtomicAgent::List& coalition) -> double
+            {
+                if(AtomicAgent::getCardinality(coalition, sherpa) != 1)
+                {
+                    return 0.0;
+                }
+                double weight = 0;
+                for(const AtomicAgent& agent : coalition)
+                {
+                    std::map<IRI, size_t>::const_iterator cit = weights.find(agent.getModel());
+                    if(cit != weights.end())
+                    {
+                        weight += cit->second;
+                    }
+                }
+                return 1.0/(1.0 + std::abs(weight - targetWeight));
+            };
+
+        utils::CoalitionStructureGeneration::CoalitionValueFunction value = coalitionValue;
+        structureValue = [value](const std::vector<AtomicAgent::List>& structure) -> double
+            {
+                double structureValue = 1.0;
+                for(const AtomicAgent::List& coalition : structure)
+                {
+                    structureValue = std::min(structureValue, value(coalition));
+                }
+                return structureValue;
+            };
+    }
+};
+
+BOOST_AUTO_TEST_CASE(organization_structure_generation_parallel)
+{
+    // A coalition requires a single sherpa, which should carry half of the
+    // total weight of 10 -- since there are three sherpas, the upper bounds
+    // of the subspaces cannot be reached, so that several subspaces have to
+    // be searched
+    WeightedPayloads payloads(4, 3, 5.0);
+    const AtomicAgent::List& agents = payloads.agents;
+    utils::CoalitionStructureGeneration::CoalitionValueFunction coalitionValue = payloads.coalitionValue;
+    utils::CoalitionStructureGeneration::CoalitionStructureValueFunction structureValue = payloads.structureValue;
+
+    utils::CoalitionStructureGeneration serial(agents, coalitionValue, structureValue);
+    std::vector<AtomicAgent::List> serialSolution = serial.findBest(1.0);
+    size_t searchedSubspaces = serial.getStatistics().searchedIntegerPartitions.size();
+    BOOST_REQUIRE_MESSAGE(searchedSubspaces > 1, "Serial search searches several subspaces, but searched " << searchedSubspaces);
+
+    for(size_t numberOfThreads : { 2, 4 })
+    {
+        utils::CoalitionStructureGeneration parallel(agents, coalitionValue, structureValue);
+        parallel.setNumberOfThreads(numberOfThreads);
+        BOOST_REQUIRE_MESSAGE(parallel.getNumberOfThreads() == numberOfThreads, "Parallel search uses " << numberOfThreads << " threads");
+        std::vector<AtomicAgent::List> solution = parallel.findBest(1.0);
+
+        BOOST_REQUIRE_MESSAGE(parallel.anytimeSearchCompleted(), "Parallel search completed");
+        BOOST_REQUIRE_MESSAGE(parallel.currentBestSolutionValue() == serial.currentBestSolutionValue(),
+                "Parallel search finds the same value as the serial search: expected "
+                << serial.currentBestSolutionValue() << ", got " << parallel.currentBestSolutionValue());
+        BOOST_REQUIRE_MESSAGE(structureValue(solution) == structureValue(serialSolution), "Parallel search finds a coalition structure of the same value: "
+                << utils::CoalitionStructureGeneration::toString(solution) << " vs. "
+                << utils::CoalitionStructureGeneration::toString(serialSolution));
+        BOOST_REQUIRE_MESSAGE(parallel.currentBestSolutionQuality() == serial.currentBestSolutionQuality(),
+                "Parallel search reaches the same quality as the serial search");
+    }
+    BOOST_REQUIRE_MESSAGE(serial.currentBestSolutionValue() == 1.0/3.0, "Best coalition structure has value 1/3, but got " << serial.currentBestSolutionValue());
+}
+
+BOOST_AUTO_TEST_CASE(coalition_value_cache)
+{
+    IRI sherpa = OM::resolve("Sherpa");
+    IRI payload = OM::resolve("Payload");
+
+    AtomicAgent::List agents;
+    agents.push_back(AtomicAgent(0, sherpa));
+    agents.push_back(AtomicAgent(0, payload));
+    agents.push_back(AtomicAgent(1, payload));
+
+    std::atomic<size_t> calls(0);
+    utils::CoalitionValueCache::CoalitionValueFunction coalitionValue =
+        [&calls](const AtomicAgent::List& coalition) -> double
+        {
+            ++calls;
+            return coalition.size();
+        };
+
+    {
+        utils::CoalitionValueCache cache(coalitionValue);
+        AtomicAgent::List coalition = { agents[0], agents[1] };
+        AtomicAgent::List reversed = { agents[1], agents[0] };
+        BOOST_REQUIRE_EQUAL(cache.getValue(coalition), 2.0);
+        BOOST_REQUIRE_EQUAL(cache.getValue(reversed), 2.0);
+        BOOST_REQUIRE_MESSAGE(calls == 1, "Value function called once for the same coalition, but was called " << calls << " times");
+        BOOST_REQUIRE_EQUAL(cache.getHits(), 1);
+        BOOST_REQUIRE_EQUAL(cache.getMisses(), 1);
+
+        double value = 0;
+        BOOST_REQUIRE_MESSAGE(!cache.lookup( AtomicAgent::List{agents[2]}, value), "Coalition has not been cached");
+    }
+
+    {
+        calls = 0;
+        utils::CoalitionValueCache cache(coalitionValue, 2);
+        cache.getValue( AtomicAgent::List{agents[0]} );
+        cache.getValue( AtomicAgent::List{agents[1]} );
+        cache.getValue( AtomicAgent::List{agents[2]} );
+        BOOST_REQUIRE_EQUAL(cache.size(), 2);
+
+        double value = 0;
+        BOOST_REQUIRE_MESSAGE(!cache.lookup( AtomicAgent::List{agents[0]}, value), "Oldest entry has been dropped");
+        BOOST_REQUIRE_MESSAGE(cache.lookup( AtomicAgent::List{agents[2]}, value), "Newest entry has been kept");
+    }
+
+    {
+        // model combinations up to size 2: [S], [P], [S,P], [P,P]
+        calls = 0;
+        utils::CoalitionValueCache::Ptr cache(new utils::CoalitionValueCache(coalitionValue));
+        cache->precompute(agents, 2, 4);
+        BOOST_REQUIRE_MESSAGE(cache->size() == 4, "Precomputed 4 coalitions, but got " << cache->size());
+        BOOST_REQUIRE_EQUAL(calls, 4);
+
+        utils::CoalitionStructureGeneration csg(agents, cache,
+            [cache](const std::vector<AtomicAgent::List>& structure) -> double
+            {
+                double value = 0.0;
+                for(const AtomicAgent::List& coalition : structure)
+                {
+                    value = std::max(value, cache->getValue(coalition));
+                }
+                return value;
+            });
+        BOOST_REQUIRE_MESSAGE(csg.getCoalitionValueCache() == cache, "Cache is used by the coalition structure generation");
+        BOOST_REQUIRE_MESSAGE(cache->getHits() > 0, "Coalition structure generation used precomputed values");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(organization_structure_generation_bounded_cache)
+{
+    IRI sherpa = OM::resolve("Sherpa");
+    IRI payload = OM::resolve("Payload");
+
+    AtomicAgent::List agents;
+    agents.push_back(AtomicAgent(0, sherpa));
+    for(size_t i = 0; i < 3; ++i)
+    {
+        agents.push_back(AtomicAgent(i, payload));
+    }
+
+    // Coalitions are not stored, so that the search succeeds even
+    // if (nearly) no coalition value can be kept
+    utils::CoalitionValueCache::Ptr cache(new utils::CoalitionValueCache(
+            [sherpa](const AtomicAgent::List& coalition) -> double
+            {
+                return AtomicAgent::getCardinality(coalition, sherpa) > 0 ? 1.0 : 0.0;
+            }, 1));
+    utils::CoalitionStructureGeneration csg(agents, cache,
+            [cache](const std::vector<AtomicAgent::List>& structure) -> double
+            {
+                double value = 1.0;
+                for(const AtomicAgent::List& coalition : structure)
+                {
+                    value = std::min(value, cache->getValue(coalition));
+                }
+                return value;
+            });
+    std::vector<AtomicAgent::List> solution = csg.findBest(1.0);
+    BOOST_REQUIRE_MESSAGE(solution.size() == 1, "Single coalition with the sherpa found: " << utils::CoalitionStructureGeneration::toString(solution));
+    BOOST_REQUIRE_MESSAGE(csg.currentBestSolutionValue() == 1.0, "Feasible coalition structure found");
+    BOOST_REQUIRE_MESSAGE(cache->size() <= 1, "Cache is bounded");
+}
+
+BOOST_AUTO_TEST_CASE(organization_structure_generation_solution_callback)
+{
+    // A coalition requires a single sherpa, and the sherpas should carry
+    // the same weight, i.e. half of the total weight of 28
+    WeightedPayloads payloads(7, 2, 14.0);
+    const AtomicAgent::List& agents = payloads.agents;
+    utils::CoalitionStructureGeneration::CoalitionValueFunction coalitionValue = payloads.coalitionValue;
+    utils::CoalitionStructureGeneration::CoalitionStructureValueFunction structureValue = payloads.structureValue;
+
+    typedef utils::CoalitionStructureGeneration::Solution Solution;
+    {
+        std::vector<Solution> solutions;
+        utils::CoalitionStructureGeneration csg(agents, coalitionValue, structureValue);
+        csg.setSolutionCallback([&solutions](const Solution& solution)
+                {
+                    solutions.push_back(solution);
+                });
+        csg.findBest(1.0);
+
+        BOOST_REQUIRE_MESSAGE(solutions.size() > 2, "Several improved solutions have been published, but got " << solutions.size());
+        for(size_t i = 1; i < solutions.size(); ++i)
+        {
+            BOOST_REQUIRE_MESSAGE(solutions[i-1].value < solutions[i].value, "Published solutions improve");
+            BOOST_REQUIRE_MESSAGE(solutions[i-1].quality > solutions[i].quality, "Quality of published solutions improves: "
+                    << solutions[i-1].quality << " vs. " << solutions[i].quality);
+        }
+        const Solution& last = solutions.back();
+        BOOST_REQUIRE_MESSAGE(last.value == csg.currentBestSolutionValue(), "Last published solution is the best solution");
+        BOOST_REQUIRE_MESSAGE(structureValue(last.coalitionStructure) == last.value, "Published value matches the coalition structure");
+        BOOST_REQUIRE_MESSAGE(last.quality == last.upperBound / last.value, "Published quality is the ratio of bound and value");
+        BOOST_REQUIRE_MESSAGE(csg.currentBestSolutionValue() == 1.0, "Balanced coalition structure found");
+        BOOST_REQUIRE_MESSAGE(csg.currentBestSolutionQuality() == 1.0, "Bound of the completed search is tight");
+    }
+
+    {
+        // Stop: the search is stopped after a fixed number of evaluations of
+        // the coalition structure value, so that it ends with the best
+        // solution found so far as for a timeout
+        std::vector<Solution> solutions;
+        size_t evaluations = 0;
+        const size_t maxEvaluations = 3;
+        utils::CoalitionStructureGeneration* csgPtr = NULL;
+        utils::CoalitionStructureGeneration csg(agents, coalitionValue,
+                [structureValue, &evaluations, &csgPtr, maxEvaluations](const std::vector<AtomicAgent::List>& structure) -> double
+                {
+                    if(++evaluations == maxEvaluations)
+                    {
+                        csgPtr->stopSearch();
+                    }
+                    return structureValue(structure);
+                });
+        csgPtr = &csg;
+        csg.setSolutionCallback([&solutions](const Solution& solution)
+                {
+                    solutions.push_back(solution);
+                });
+        csg.findBest(1.0);
+        BOOST_REQUIRE_MESSAGE(evaluations == maxEvaluations, "Search stopped after " << maxEvaluations << " evaluations, but got " << evaluations);
+        BOOST_REQUIRE_MESSAGE(!solutions.empty(), "Solutions have been published before the stop");
+        for(size_t i = 1; i < solutions.size(); ++i)
+        {
+            BOOST_REQUIRE_MESSAGE(solutions[i-1].quality > solutions[i].quality, "Quality of published solutions improves: "
+                    << solutions[i-1].quality << " vs. " << solutions[i].quality);
+        }
+        BOOST_REQUIRE_MESSAGE(solutions.back().value == csg.currentBestSolutionValue(), "Last published solution is the best solution");
+        BOOST_REQUIRE_MESSAGE(csg.currentBestSolutionValue() < 1.0, "Search stopped before the optimum has been found");
+        BOOST_REQUIRE_MESSAGE(csg.currentBestSolutionQuality() > 1.0, "Bound of the stopped search is not tight, but quality is "
+                << csg.currentBestSolutionQuality());
+
+        // A new search is not affected by the previous stop
+        evaluations = maxEvaluations;
+        csg.findBest(1.0);
+        BOOST_REQUIRE_MESSAGE(csg.currentBestSolutionValue() == 1.0, "Restarted search finds the balanced coalition structure");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(robotpool)
 {
     using namespace owlapi::vocabulary;
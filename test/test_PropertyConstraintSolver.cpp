@@ -32,6 +32,64 @@ BOOST_AUTO_TEST_CASE(value_bound)
     }
 }
 
+BOOST_AUTO_TEST_CASE(value_bound_intervals)
+{
+    owlapi::model::IRI propertyA("http://test/propertyA");
+    owlapi::model::IRI propertyB("http://test/propertyB");
+
+    std::vector<PropertyConstraint::ConstraintType> types = { PropertyConstraint::EQUAL,
+        PropertyConstraint::LESS_EQUAL, PropertyConstraint::GREATER_EQUAL };
+    std::vector<double> values = { 1.0, 2.5, 3.0, 8.5, 10.0 };
+
+    PropertyConstraint::List candidates;
+    for(PropertyConstraint::ConstraintType type : types)
+    {
+        for(double value : values)
+        {
+            candidates.push_back(PropertyConstraint(propertyA, type, value));
+        }
+    }
+
+    for(const PropertyConstraint& a0 : candidates)
+    {
+        for(const PropertyConstraint& a1 : candidates)
+        {
+            for(const PropertyConstraint& b : candidates)
+            {
+                PropertyConstraint::Set constraints = { a0, a1,
+                    PropertyConstraint(propertyB, b.getType(), b.getValue()) };
+
+                bool feasible = true;
+                ValueBound vb;
+                try {
+                    vb = PropertyConstraintSolver::mergeIntervals(constraints);
+                } catch(const std::invalid_argument& e)
+                {
+                    feasible = false;
+                }
+
+                bool feasibleCSP = true;
+                ValueBound vbCSP;
+                try {
+                    vbCSP = PropertyConstraintSolver::mergeCSP(constraints);
+                } catch(const std::invalid_argument& e)
+                {
+                    feasibleCSP = false;
+                }
+
+                BOOST_REQUIRE_MESSAGE(feasible == feasibleCSP, "Interval and CSP merge differ for: "
+                        << PropertyConstraint::toString(constraints, 4));
+                if(feasible)
+                {
+                    BOOST_REQUIRE_MESSAGE(vb.getMin() == vbCSP.getMin() && vb.getMax() == vbCSP.getMax(),
+                            "Interval merge: " << vb.toString() << " differs from CSP merge: "
+                            << vbCSP.toString() << " for " << PropertyConstraint::toString(constraints, 4));
+                }
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(fulfillment)
 {
     //std::string filename = "" + getRootDir() +